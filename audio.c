@@ -0,0 +1,196 @@
+/*
+ * audio.c - SDL_mixer setup and audio timing statistics.
+ *
+ * A post-mix hook timestamps every buffer the device pulls from the mixer,
+ * which gives us the real buffer size and the callback period/jitter
+ * instead of trusting the values we asked for. SDL does not report how far
+ * the device has got through a buffer, so the output latency is only an
+ * estimate worked out from the buffer size.
+ *
+ * For video export the music is pulled offline instead: the synth is
+ * run directly, or music.ogg is decoded up front and copied out.
+ */
+
+#include <SDL.h>
+#include <SDL_mixer.h>
+#include <stdio.h>
+#include <string.h>
+#include <math.h>
+#include "audio.h"
+#include "synth.h"
+
+// --- Globals ---
+static Mix_Music* music = NULL;
+static Mix_Chunk* offline_music = NULL; // Whole song in the mixer's format
+static Uint32 offline_pos = 0;          // Bytes into offline_music
+static Uint16 audio_format = 0;
+static SDL_mutex* timing_lock = NULL;
+static int audio_rate = 0;
+static int audio_channels = 0;
+static int audio_sample_bytes = 0;
+static int audio_requested_chunk = 0;
+static int audio_use_synth = 0;
+
+// Written on the audio thread, read under timing_lock
+static Uint64 last_callback = 0;
+static int last_frames = 0;
+static unsigned long period_count = 0;
+static double period_sum = 0.0;
+static double period_sum_sq = 0.0;
+static double period_max = 0.0;
+
+
+// Called by SDL_mixer after each buffer has been mixed
+static void post_mix_timing(void* udata, Uint8* stream, int len) {
+    Uint64 now = SDL_GetPerformanceCounter();
+
+    SDL_LockMutex(timing_lock);
+    last_frames = len / (audio_channels * audio_sample_bytes);
+    if (last_callback != 0) {
+        double ms = (double)(now - last_callback) * 1000.0 / (double)SDL_GetPerformanceFrequency();
+        period_sum += ms;
+        period_sum_sq += ms * ms;
+        if (ms > period_max) period_max = ms;
+        period_count++;
+    }
+    last_callback = now;
+    SDL_UnlockMutex(timing_lock);
+}
+
+// Initialize SDL_mixer and load music (or prepare the built-in synth)
+int init_audio(int rate, int chunk, int use_synth) {
+    if (Mix_OpenAudio(rate, MIX_DEFAULT_FORMAT, 2, chunk) < 0) {
+        printf("SDL_mixer could not initialize! Mix_Error: %s\n", Mix_GetError());
+        return 1;
+    }
+
+    // The device may not grant exactly what we asked for
+    Uint16 format;
+    Mix_QuerySpec(&audio_rate, &format, &audio_channels);
+    audio_format = format;
+    audio_sample_bytes = SDL_AUDIO_BITSIZE(format) / 8;
+    audio_requested_chunk = chunk;
+    if (audio_rate != rate) {
+        printf("Audio: requested %d Hz, device opened at %d Hz\n", rate, audio_rate);
+    }
+
+    timing_lock = SDL_CreateMutex();
+    if (!timing_lock) {
+        printf("Could not create audio timing mutex! SDL_Error: %s\n", SDL_GetError());
+        return 1;
+    }
+    Mix_SetPostMix(post_mix_timing, NULL);
+
+    if (use_synth) {
+        if (format != AUDIO_S16SYS) {
+            printf("Synth needs 16-bit output, device opened with format 0x%04x\n", format);
+            return 1;
+        }
+        audio_use_synth = 1;
+        return init_synth(audio_rate, audio_channels);
+    }
+
+    // IMPORTANT: You must provide a path to a music file.
+    // This example assumes a file named "music.ogg" is in the same directory.
+    music = Mix_LoadMUS("music.ogg");
+    if (!music) {
+        printf("Failed to load music! Mix_Error: %s\n", Mix_GetError());
+        printf("Please ensure 'music.ogg' is in the same directory as the executable.\n");
+        SDL_Delay(5000);
+        return 1;
+    }
+    return 0;
+}
+
+// Start the background music, looping forever
+void play_audio() {
+    if (audio_use_synth) {
+        Mix_HookMusic(synth_mix, NULL);
+    } else {
+        Mix_PlayMusic(music, -1);
+    }
+}
+
+// Get ready to render the music offline; play_audio() must not be called
+int init_offline_audio() {
+    if (audio_format != AUDIO_S16SYS) {
+        printf("Audio export needs 16-bit output, mixer opened with format 0x%04x\n", audio_format);
+        return 1;
+    }
+    if (audio_use_synth) return 0;
+
+    // Decodes the whole file and converts it to the mixer's format
+    offline_music = Mix_LoadWAV("music.ogg");
+    if (!offline_music) {
+        printf("Failed to decode music for export! Mix_Error: %s\n", Mix_GetError());
+        return 1;
+    }
+    offline_pos = 0;
+    return 0;
+}
+
+// The next `frames` sample frames of the soundtrack, looping like the live music
+void render_offline_audio(Sint16* out, int frames) {
+    Uint32 len = (Uint32)(frames * audio_channels * sizeof(Sint16));
+    if (audio_use_synth) {
+        synth_mix(NULL, (Uint8*)out, (int)len);
+        return;
+    }
+    if (!offline_music || offline_music->alen == 0) {
+        memset(out, 0, len);
+        return;
+    }
+
+    Uint8* dst = (Uint8*)out;
+    while (len > 0) {
+        Uint32 n = offline_music->alen - offline_pos;
+        if (n > len) n = len;
+        memcpy(dst, offline_music->abuf + offline_pos, n);
+        dst += n;
+        len -= n;
+        offline_pos += n;
+        if (offline_pos >= offline_music->alen) offline_pos = 0;
+    }
+}
+
+// Copy out the current timing figures
+void get_audio_stats(AudioStats* out) {
+    SDL_LockMutex(timing_lock);
+    int frames = last_frames;
+    unsigned long count = period_count;
+    double sum = period_sum;
+    double sum_sq = period_sum_sq;
+    double max = period_max;
+    SDL_UnlockMutex(timing_lock);
+
+    out->rate = audio_rate;
+    out->channels = audio_channels;
+    out->requested_chunk = audio_requested_chunk;
+    out->buffer_frames = frames;
+    out->buffer_ms = audio_rate > 0 ? frames * 1000.0f / audio_rate : 0.0f;
+    // Estimate: one buffer is playing while the next one is queued behind it
+    out->latency_estimate_ms = out->buffer_ms * 2.0f;
+    out->callbacks = count;
+    out->period_ms = 0.0f;
+    out->jitter_ms = 0.0f;
+    out->max_period_ms = (float)max;
+    if (count > 0) {
+        double mean = sum / count;
+        double var = sum_sq / count - mean * mean;
+        out->period_ms = (float)mean;
+        out->jitter_ms = (float)sqrt(var > 0.0 ? var : 0.0);
+    }
+}
+
+// Release the music and close the mixer
+void cleanup_audio() {
+    Mix_SetPostMix(NULL, NULL);
+    Mix_HookMusic(NULL, NULL);
+    if (music) Mix_FreeMusic(music);
+    if (offline_music) Mix_FreeChunk(offline_music);
+    music = NULL;
+    offline_music = NULL;
+    Mix_CloseAudio();
+    if (timing_lock) SDL_DestroyMutex(timing_lock);
+    timing_lock = NULL;
+}
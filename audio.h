@@ -0,0 +1,36 @@
+/*
+ * audio.h - SDL_mixer setup and audio timing statistics.
+ */
+
+#ifndef AUDIO_H
+#define AUDIO_H
+
+#include <SDL.h>
+
+#define AUDIO_DEFAULT_RATE 44100
+#define AUDIO_DEFAULT_CHUNK 2048
+
+// Audio timing as measured on the mixer thread
+typedef struct {
+    int rate;             // Sample rate actually granted by the device
+    int channels;
+    int requested_chunk;  // Chunk size asked for on the command line
+    int buffer_frames;    // Frames per callback actually delivered by the device
+    float buffer_ms;      // buffer_frames expressed in milliseconds
+    float latency_estimate_ms; // Output latency guessed from the buffer size, not measured
+    float period_ms;      // Mean time between mixer callbacks
+    float jitter_ms;      // Standard deviation of the callback period
+    float max_period_ms;  // Worst callback period seen
+    unsigned long callbacks;
+} AudioStats;
+
+int init_audio(int rate, int chunk, int use_synth);
+void play_audio();
+
+// Offline rendering for export: pull the music instead of playing it
+int init_offline_audio();
+void render_offline_audio(Sint16* out, int frames);
+void get_audio_stats(AudioStats* out);
+void cleanup_audio();
+
+#endif
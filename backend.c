@@ -0,0 +1,216 @@
+/*
+ * backend.c - Render driver listing, lookup and probing.
+ */
+
+#include <SDL.h>
+#include <stdio.h>
+#include <string.h>
+#include "backend.h"
+#include "cmdbuf.h"
+
+// --- Constants ---
+#define PROBE_WARMUP_FRAMES 5
+#define PROBE_FRAMES 60
+#define PROBE_MAX_SECONDS 0.5 // Per driver, so a slow software path can't stall startup
+#define PROBE_STARS 500
+#define PROBE_LAYER_W 800
+#define PROBE_LAYER_H 600
+#define CACHE_ORG "CScroller"
+#define CACHE_APP "demo"
+#define CACHE_FILE "renderer.txt"
+#define CACHE_KEY_LEN 128
+
+// Print the drivers in SDL's default preference order
+void list_render_drivers() {
+    int count = SDL_GetNumRenderDrivers();
+    printf("Available renderers:\n");
+    for (int i = 0; i < count; i++) {
+        SDL_RendererInfo info;
+        if (SDL_GetRenderDriverInfo(i, &info) != 0) continue;
+        printf("  %-12s%s%s%s\n", info.name,
+               (info.flags & SDL_RENDERER_ACCELERATED) ? " accelerated" : "",
+               (info.flags & SDL_RENDERER_SOFTWARE) ? " software" : "",
+               (info.flags & SDL_RENDERER_TARGETTEXTURE) ? " targets" : "");
+    }
+}
+
+int find_render_driver(const char* name) {
+    int count = SDL_GetNumRenderDrivers();
+    for (int i = 0; i < count; i++) {
+        SDL_RendererInfo info;
+        if (SDL_GetRenderDriverInfo(i, &info) == 0 && SDL_strcasecmp(info.name, name) == 0) {
+            return i;
+        }
+    }
+    return -1;
+}
+
+// --- Winner cache ---
+
+static char* cache_path() {
+    char* dir = SDL_GetPrefPath(CACHE_ORG, CACHE_APP);
+    if (!dir) return NULL;
+    size_t len = strlen(dir) + sizeof(CACHE_FILE);
+    char* path = SDL_malloc(len);
+    if (path) SDL_snprintf(path, len, "%s%s", dir, CACHE_FILE);
+    SDL_free(dir);
+    return path;
+}
+
+// What a probe result depends on besides the machine: the SDL library in
+// use and the video driver it runs on
+static void cache_key(char* out, size_t len) {
+    SDL_version v;
+    SDL_GetVersion(&v);
+    const char* video = SDL_GetCurrentVideoDriver();
+    SDL_snprintf(out, len, "SDL-%d.%d.%d %s", v.major, v.minor, v.patch, video ? video : "none");
+}
+
+// The cached winner, or -1 when there is none or it was probed elsewhere
+static int load_cached_driver() {
+    char* path = cache_path();
+    if (!path) return -1;
+    int index = -1;
+    FILE* f = fopen(path, "r");
+    if (f) {
+        char name[64], sdl[32], video[64], key[CACHE_KEY_LEN], saved[CACHE_KEY_LEN];
+        cache_key(key, sizeof(key));
+        if (fscanf(f, "%63s %31s %63s", name, sdl, video) == 3) {
+            SDL_snprintf(saved, sizeof(saved), "%s %s", sdl, video);
+            if (strcmp(saved, key) == 0) index = find_render_driver(name);
+            else printf("Renderer cache is from %s, this is %s: probing again\n", saved, key);
+        }
+        fclose(f);
+    }
+    SDL_free(path);
+    return index;
+}
+
+static void save_cached_driver(const char* name) {
+    char* path = cache_path();
+    if (!path) return;
+    char key[CACHE_KEY_LEN];
+    cache_key(key, sizeof(key));
+    FILE* f = fopen(path, "w");
+    if (f) {
+        fprintf(f, "%s %s\n", name, key);
+        fclose(f);
+    }
+    SDL_free(path);
+}
+
+// Drop the cached winner, e.g. because it no longer starts
+void forget_render_driver() {
+    char* path = cache_path();
+    if (!path) return;
+    remove(path);
+    SDL_free(path);
+}
+
+// --- Probe ---
+
+// Same shape of work as the show: a layered starfield of small opaque
+// fills, a blended raster bar and tinted text copies, composited through
+// render targets and batched by the command buffer
+static void probe_frame(SDL_Renderer* r, SDL_Texture* layer, SDL_Texture* text, int frame) {
+    SDL_SetRenderTarget(r, layer);
+    SDL_SetRenderDrawColor(r, 0, 0, 0, 0);
+    SDL_RenderClear(r);
+    SDL_Color white = { 255, 255, 255, 255 };
+    for (int i = 0; i < PROBE_STARS; i++) {
+        int size = 1 + (i + frame) % 3;
+        SDL_Rect star = { (i * 97 + frame * 3) % PROBE_LAYER_W, (i * 61 + frame) % PROBE_LAYER_H, size, size };
+        cmd_fill_rect(&star, white, SDL_BLENDMODE_NONE);
+    }
+    cmd_flush(r);
+    SDL_SetRenderTarget(r, NULL);
+
+    SDL_SetRenderDrawColor(r, 0, 0, 0, 255);
+    SDL_RenderClear(r);
+    cmd_next_group();
+    cmd_copy(layer, NULL, NULL, white, SDL_BLENDMODE_BLEND);
+
+    cmd_next_group();
+    SDL_Rect bar = { 0, (frame * 7) % (PROBE_LAYER_H - 75), PROBE_LAYER_W, 75 };
+    SDL_Color bar_color = { 255, 0, 255, 100 };
+    cmd_fill_rect(&bar, bar_color, SDL_BLENDMODE_BLEND);
+
+    cmd_next_group();
+    SDL_Color tint = { (Uint8)(frame * 5), 128, 255, 255 };
+    for (int i = 0; i < 10; i++) { // Scroller plus the title's outline ring
+        SDL_Rect dst = { PROBE_LAYER_W - (frame * 4 + i * 8) % (2 * PROBE_LAYER_W), 200 + i * 4, 1024, 32 };
+        cmd_copy(text, NULL, &dst, tint, SDL_BLENDMODE_BLEND);
+    }
+    cmd_present(r);
+}
+
+// Frames per second for one driver, or 0 if it can't run the demo
+static double probe_driver(SDL_Window* window, int index) {
+    SDL_Renderer* r = SDL_CreateRenderer(window, index, 0); // No vsync while timing
+    if (!r) return 0.0;
+
+    double fps = 0.0;
+    SDL_RendererInfo info;
+    SDL_Texture* layer = NULL;
+    SDL_Texture* text = NULL;
+    SDL_Surface* surface = SDL_CreateRGBSurfaceWithFormat(0, 1024, 32, 32, SDL_PIXELFORMAT_ARGB8888);
+    if (surface && SDL_GetRendererInfo(r, &info) == 0 && (info.flags & SDL_RENDERER_TARGETTEXTURE)) {
+        SDL_FillRect(surface, NULL, SDL_MapRGBA(surface->format, 255, 255, 255, 200));
+        text = SDL_CreateTextureFromSurface(r, surface);
+        // Same format as the show's layers, so the probe times the same path
+        layer = SDL_CreateTexture(r, SDL_PIXELFORMAT_ARGB8888, SDL_TEXTUREACCESS_TARGET,
+                                  PROBE_LAYER_W, PROBE_LAYER_H);
+    }
+    if (layer && text) {
+        SDL_SetTextureBlendMode(layer, SDL_BLENDMODE_BLEND);
+        SDL_SetTextureBlendMode(text, SDL_BLENDMODE_BLEND);
+        for (int i = 0; i < PROBE_WARMUP_FRAMES; i++) probe_frame(r, layer, text, i);
+
+        Uint64 start = SDL_GetPerformanceCounter();
+        Uint64 limit = (Uint64)(PROBE_MAX_SECONDS * SDL_GetPerformanceFrequency());
+        int frames = 0;
+        while (frames < PROBE_FRAMES && SDL_GetPerformanceCounter() - start < limit) {
+            probe_frame(r, layer, text, frames++);
+        }
+        // Read back a pixel so queued GPU work is included in the time
+        Uint32 pixel;
+        SDL_Rect one = { 0, 0, 1, 1 };
+        SDL_RenderReadPixels(r, &one, SDL_PIXELFORMAT_ARGB8888, &pixel, sizeof(pixel));
+        double seconds = (double)(SDL_GetPerformanceCounter() - start) / SDL_GetPerformanceFrequency();
+        if (seconds > 0.0) fps = frames / seconds;
+    }
+
+    if (surface) SDL_FreeSurface(surface);
+    if (text) SDL_DestroyTexture(text);
+    if (layer) SDL_DestroyTexture(layer);
+    SDL_DestroyRenderer(r);
+    return fps;
+}
+
+// Index of the fastest driver, or -1 to let SDL choose. With reprobe set
+// the cache is ignored and overwritten
+int probe_render_drivers(SDL_Window* window, int reprobe) {
+    int cached = reprobe ? -1 : load_cached_driver();
+    if (cached >= 0) return cached;
+
+    int best = -1;
+    double best_fps = 0.0;
+    int count = SDL_GetNumRenderDrivers();
+    for (int i = 0; i < count; i++) {
+        SDL_RendererInfo info;
+        if (SDL_GetRenderDriverInfo(i, &info) != 0) continue;
+        double fps = probe_driver(window, i);
+        printf("Renderer probe: %-12s %8.1f fps\n", info.name, fps);
+        if (fps > best_fps) {
+            best_fps = fps;
+            best = i;
+        }
+    }
+
+    if (best >= 0) {
+        SDL_RendererInfo info;
+        SDL_GetRenderDriverInfo(best, &info);
+        save_cached_driver(info.name);
+    }
+    return best;
+}
@@ -0,0 +1,22 @@
+/*
+ * backend.h - Render driver selection.
+ *
+ * Lists the SDL render drivers compiled into this build, looks one up by
+ * name for --renderer, and for --auto-renderer times the demo's draw mix
+ * on each driver and picks the fastest. The winner is cached in the
+ * per-user preferences directory so later runs on the same machine skip
+ * the probe. The cache names the SDL version and video driver it was
+ * probed with and is ignored once either changes.
+ */
+
+#ifndef BACKEND_H
+#define BACKEND_H
+
+#include <SDL.h>
+
+void list_render_drivers();
+int find_render_driver(const char* name);
+int probe_render_drivers(SDL_Window* window, int reprobe);
+void forget_render_driver();
+
+#endif
@@ -0,0 +1,411 @@
+/*
+ * bench.c - Micro-benchmarks for the demo's hot routines.
+ *
+ * Times the inner loops in isolation, on fixed inputs from a fixed seed,
+ * for every kernel set the CPU supports, and prints nanoseconds per
+ * element. Given a baseline file it also prints the change against it;
+ * --save writes the current figures as the new baseline.
+ *
+ *   ./scroller_bench [--save] [BASELINE]
+ *
+ * Built and run by `make bench` (compare) and `make bench-baseline` (save).
+ * Baselines are only comparable on the machine that recorded them.
+ */
+
+#define SDL_MAIN_HANDLED
+#include <SDL.h>
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "effect.h"
+#include "kernels.h"
+#include "tiles.h"
+
+// --- Constants ---
+#define BENCH_SEED 12345u
+#define BENCH_MIN_MS 50.0 // Per run
+#define BENCH_RUNS 5      // Best of
+#define BENCH_MAX 64
+#define BENCH_NAME_LEN 48
+#define REGRESSION_PCT 10.0
+
+#define NUM_STARS 500     // As in fx_stars.c
+#define STAR_SPREAD 512
+#define SPAN_LEN 800      // One row of the default window
+#define COLOUR_STEPS 1024
+#define TEXT_W 1200       // Roughly the scroller text at 24pt
+#define TEXT_H 28
+#define BENCH_BLOBS 16    // Metaballs over one block row, a dense spot
+#define PLASMA_W 1920     // Whole plasma frames at 1080p
+#define PLASMA_H 1080
+#define PLASMA_CHUNK 256  // As in fx_plasma.c
+#define WAVE_STEPS 1024
+#define FRAME_BUDGET_MS (1000.0 / 60.0)
+
+typedef struct {
+    char name[BENCH_NAME_LEN];
+    double ns;
+} Result;
+
+// --- Inputs, filled once from the fixed seed ---
+static Uint32 seed = BENCH_SEED;
+static float star_x[NUM_STARS], star_y[NUM_STARS], star_z[NUM_STARS], star_speed[NUM_STARS];
+static float proj_x[NUM_STARS], proj_y[NUM_STARS], proj_size[NUM_STARS];
+static Uint32 span[SPAN_LEN];
+static Uint32 row_src[SPAN_LEN];
+static Uint8 plasma_col[SPAN_LEN], plasma_diag[SPAN_LEN];
+static Uint32 palette[256];
+static Uint8 plasma_wave[WAVE_STEPS];
+static Uint32 plasma_frame[PLASMA_W * PLASMA_H];
+static Uint16 tunnel_uv[SPAN_LEN];
+static Uint8 tunnel_shade[SPAN_LEN];
+static Uint32 tunnel_texture[256 * 256];
+static Uint8 fire_below[SPAN_LEN + 2], fire_below2[SPAN_LEN], fire_out[SPAN_LEN];
+static float blob_x[BENCH_BLOBS], blob_y[BENCH_BLOBS], blob_inv_r2[BENCH_BLOBS];
+static Uint32 framebuffer[TILE_SIZE * TILE_SIZE];
+static Uint32 text_pixels[TEXT_W * TEXT_H];
+static TileImage text_image = { text_pixels, TEXT_W, TEXT_H };
+static volatile Uint32 sink; // Keeps results alive
+
+static Result results[BENCH_MAX];
+static int result_count = 0;
+
+
+static Uint32 next_random() {
+    seed = seed * 1664525u + 1013904223u;
+    return seed >> 8;
+}
+
+static void fill_inputs() {
+    for (int i = 0; i < NUM_STARS; i++) {
+        star_x[i] = (float)(next_random() % STAR_SPREAD) - (STAR_SPREAD / 2);
+        star_y[i] = (float)(next_random() % STAR_SPREAD) - (STAR_SPREAD / 2);
+        star_z[i] = (float)(next_random() % STAR_SPREAD + 1);
+        star_speed[i] = (float)(next_random() % 100) / 200.0f + 0.2f;
+    }
+    for (int i = 0; i < SPAN_LEN; i++) {
+        span[i] = 0xff000000 | next_random();
+        row_src[i] = next_random() << 8 | (next_random() & 0xff);
+    }
+    // Glyph-like coverage: mostly empty, some solid, some edges
+    for (int i = 0; i < TEXT_W * TEXT_H; i++) {
+        Uint32 r = next_random() % 8;
+        Uint32 a = r < 5 ? 0 : r < 7 ? 255 : next_random() & 0xff;
+        text_pixels[i] = a << 24 | 0x00ffffff;
+    }
+    for (int i = 0; i < SPAN_LEN; i++) {
+        plasma_col[i] = (Uint8)next_random();
+        plasma_diag[i] = (Uint8)next_random();
+    }
+    for (int i = 0; i < 256; i++) palette[i] = 0xff000000 | next_random();
+    for (int i = 0; i < WAVE_STEPS; i++) plasma_wave[i] = (Uint8)(32 + 31 * sinf(i * 6.2831853f / WAVE_STEPS));
+    for (int i = 0; i < SPAN_LEN; i++) {
+        tunnel_uv[i] = (Uint16)next_random();
+        tunnel_shade[i] = (Uint8)next_random();
+    }
+    for (int i = 0; i < 256 * 256; i++) tunnel_texture[i] = 0xff000000 | next_random();
+    for (int i = 0; i < SPAN_LEN + 2; i++) fire_below[i] = (Uint8)next_random();
+    for (int i = 0; i < SPAN_LEN; i++) fire_below2[i] = (Uint8)next_random();
+    // Blobs 30 to 90 px across, all reaching the bench row
+    for (int i = 0; i < BENCH_BLOBS; i++) {
+        float r = 15.0f + (float)(next_random() % 30);
+        blob_x[i] = (float)(next_random() % TILE_SIZE);
+        blob_y[i] = (float)(next_random() % 256) / 256.0f * r;
+        blob_inv_r2[i] = 1.0f / (r * r);
+    }
+}
+
+// --- Routines under test; each returns the number of elements it processed ---
+
+static int bench_star_update() {
+    kernels->advance_stars(star_z, star_speed, NUM_STARS, 0.5f);
+    // Respawn as fx_stars.c does, without the rand() calls
+    for (int i = 0; i < NUM_STARS; i++) {
+        if (star_z[i] <= 0) star_z[i] = STAR_SPREAD;
+    }
+    return NUM_STARS;
+}
+
+static int bench_star_projection() {
+    kernels->project_stars(star_x, star_y, star_z, NUM_STARS, 400.0f, 300.0f, STAR_SPREAD,
+                           proj_x, proj_y, proj_size);
+    int visible = 0;
+    for (int i = 0; i < NUM_STARS; i++) {
+        int x = (int)proj_x[i], y = (int)proj_y[i];
+        visible += x >= 0 && x < 800 && y >= 0 && y < 600;
+    }
+    sink += visible;
+    return NUM_STARS;
+}
+
+// The stars as object vertices, turned and pushed back like fx_vector.c's
+static int bench_vertex_transform() {
+    static const float m[12] = { 0.36f, -0.48f, 0.8f, 0.0f, 0.8f, 0.6f, 0.0f, 0.0f, -0.48f, 0.64f, 0.6f, 130.0f };
+    kernels->transform_points(star_x, star_y, star_z, NUM_STARS, m, proj_x, proj_y, proj_size);
+    sink += (Uint32)proj_size[NUM_STARS - 1];
+    return NUM_STARS;
+}
+
+static int bench_colour_cycle() {
+    Uint32 acc = 0;
+    for (int i = 0; i < COLOUR_STEPS; i++) {
+        SDL_Color c = color_cycle(i * 0.05f);
+        acc += c.r + c.g + c.b;
+    }
+    sink += acc;
+    return COLOUR_STEPS;
+}
+
+static int bench_fill_span() {
+    kernels->fill_span(span, SPAN_LEN, 0xff102030);
+    return SPAN_LEN;
+}
+
+static int bench_blend_span() {
+    kernels->blend_span(span, SPAN_LEN, 0xffff00ff, 101);
+    return SPAN_LEN;
+}
+
+static int bench_blend_row() {
+    kernels->blend_row(span, row_src, SPAN_LEN, 200, 120, 255, 230);
+    return SPAN_LEN;
+}
+
+static int bench_plasma_span() {
+    kernels->plasma_span(span, plasma_col, plasma_diag, 77, palette, SPAN_LEN);
+    return SPAN_LEN;
+}
+
+// A whole 1080p frame the way fx_plasma.c draws it: wave tables per
+// 64-row band and column chunk, then one span per row
+static int bench_plasma_1080p() {
+    static Uint32 frame;
+    Uint8 col[PLASMA_CHUNK], diag[PLASMA_CHUNK + TILE_SIZE];
+    frame++;
+    for (int y0 = 0; y0 < PLASMA_H; y0 += TILE_SIZE) {
+        int h = SDL_min(TILE_SIZE, PLASMA_H - y0);
+        for (int x0 = 0; x0 < PLASMA_W; x0 += PLASMA_CHUNK) {
+            int w = SDL_min(PLASMA_CHUNK, PLASMA_W - x0);
+            for (int i = 0; i < w; i++) {
+                col[i] = plasma_wave[(x0 + i) * 5 % WAVE_STEPS] + plasma_wave[((x0 + i) * 3 + frame) % WAVE_STEPS];
+            }
+            for (int i = 0; i < w + h - 1; i++) diag[i] = plasma_wave[(x0 + y0 + i) * 2 % WAVE_STEPS];
+            for (int y = 0; y < h; y++) {
+                kernels->plasma_span(plasma_frame + (size_t)(y0 + y) * PLASMA_W + x0, col, diag + y,
+                                     plasma_wave[(y0 + y) * 4 % WAVE_STEPS], palette, w);
+            }
+        }
+    }
+    return PLASMA_W * PLASMA_H;
+}
+
+static int bench_tunnel_span() {
+    kernels->tunnel_span(span, tunnel_uv, tunnel_shade, 0x2a17, 230, tunnel_texture, SPAN_LEN);
+    return SPAN_LEN;
+}
+
+// 45 degrees at about one texel per pixel, on the tunnel's texture
+static int bench_rotozoom_span() {
+    kernels->rotozoom_span(span, 0x12345678, 0x9abcdef0, 0xb505, 0xb505, 230, tunnel_texture, SPAN_LEN);
+    return SPAN_LEN;
+}
+
+static int bench_fire_row() {
+    kernels->fire_row(fire_out, fire_below + 1, fire_below2, SPAN_LEN, 3);
+    return SPAN_LEN;
+}
+
+// About a quarter of a heat cell per pixel, as at 1080p
+static int bench_heat_span() {
+    kernels->heat_span(span, fire_below + 1, 0x2000, 0x4719, palette, SPAN_LEN);
+    return SPAN_LEN;
+}
+
+// One block row with BENCH_BLOBS blobs in reach
+static int bench_metaball_span() {
+    kernels->metaball_span(span, 0.5f, 0.5f, blob_x, blob_y, blob_inv_r2, BENCH_BLOBS, palette, TILE_SIZE);
+    return TILE_SIZE;
+}
+
+// The raster bar: a translucent rectangle across a whole tile
+static int bench_raster_fill() {
+    Tile t = { framebuffer, TILE_SIZE, 0, 0, TILE_SIZE, TILE_SIZE, 1.0f };
+    SDL_Rect bar = { 0, 0, TILE_SIZE, TILE_SIZE };
+    SDL_Color color = { 255, 0, 255, 100 };
+    tile_fill_rect(&t, &bar, color);
+    return TILE_SIZE * TILE_SIZE;
+}
+
+// Tinted text across a tile, at 1:1 and at the scale of a 900 px tall window
+static int text_blit(float scale) {
+    Tile t = { framebuffer, TILE_SIZE, 0, 0, TILE_SIZE, TILE_SIZE, scale };
+    int h = (int)(TILE_SIZE / scale) + 1;
+    SDL_Rect dst = { -100, 0, TEXT_W, h };
+    SDL_Color mod = { 40, 200, 255, 230 };
+    tile_blit(&t, &text_image, &dst, mod);
+    return TILE_SIZE * TILE_SIZE;
+}
+
+static int bench_text_blit() {
+    return text_blit(1.0f);
+}
+
+static int bench_text_blit_scaled() {
+    return text_blit(1.5f);
+}
+
+typedef struct {
+    const char* name;
+    int (*run)();
+    int per_kernel_set; // Timed once per kernel set
+} Bench;
+
+static const Bench benches[] = {
+    { "star_update", bench_star_update, 1 },
+    { "star_projection", bench_star_projection, 1 },
+    { "vertex_transform", bench_vertex_transform, 1 },
+    { "colour_cycle", bench_colour_cycle, 0 },
+    { "fill_span", bench_fill_span, 1 },
+    { "blend_span", bench_blend_span, 1 },
+    { "blend_row", bench_blend_row, 1 },
+    { "plasma_span", bench_plasma_span, 1 },
+    { "plasma_1080p", bench_plasma_1080p, 1 },
+    { "tunnel_span", bench_tunnel_span, 1 },
+    { "rotozoom_span", bench_rotozoom_span, 1 },
+    { "fire_row", bench_fire_row, 1 },
+    { "heat_span", bench_heat_span, 1 },
+    { "metaball_span", bench_metaball_span, 1 },
+    { "raster_fill", bench_raster_fill, 1 },
+    { "text_blit", bench_text_blit, 1 },
+    { "text_blit_scaled", bench_text_blit_scaled, 1 },
+};
+
+// Best-of-N ns per element
+static double time_bench(const Bench* b) {
+    double to_ns = 1e9 / SDL_GetPerformanceFrequency();
+    double best = 0.0;
+    for (int run = 0; run < BENCH_RUNS; run++) {
+        long elements = 0;
+        Uint64 start = SDL_GetPerformanceCounter();
+        Uint64 elapsed;
+        do {
+            for (int i = 0; i < 64; i++) elements += b->run();
+            elapsed = SDL_GetPerformanceCounter() - start;
+        } while (elapsed * to_ns < BENCH_MIN_MS * 1e6);
+        double ns = elapsed * to_ns / elements;
+        if (run == 0 || ns < best) best = ns;
+    }
+    return best;
+}
+
+static void record(const char* name, double ns) {
+    if (result_count == BENCH_MAX) return;
+    Result* r = &results[result_count++];
+    snprintf(r->name, sizeof(r->name), "%s", name);
+    r->ns = ns;
+}
+
+static int load_baseline(const char* path, Result* out) {
+    FILE* f = fopen(path, "r");
+    if (!f) return 0;
+    int n = 0;
+    char line[128];
+    while (n < BENCH_MAX && fgets(line, sizeof(line), f)) {
+        if (line[0] == '#') continue;
+        if (sscanf(line, "%47s %lf", out[n].name, &out[n].ns) == 2) n++;
+    }
+    fclose(f);
+    return n;
+}
+
+static int save_baseline(const char* path) {
+    FILE* f = fopen(path, "w");
+    if (!f) {
+        printf("Could not write %s\n", path);
+        return 1;
+    }
+    fprintf(f, "# ns/element from scroller_bench; only comparable on the machine that recorded it\n");
+    for (int i = 0; i < result_count; i++) {
+        fprintf(f, "%s %.4f\n", results[i].name, results[i].ns);
+    }
+    fclose(f);
+    printf("Saved %d results to %s\n", result_count, path);
+    return 0;
+}
+
+int main(int argc, char* argv[]) {
+    int save = 0;
+    const char* baseline_path = NULL;
+    for (int i = 1; i < argc; i++) {
+        if (strcmp(argv[i], "--save") == 0) {
+            save = 1;
+        } else if (argv[i][0] != '-') {
+            baseline_path = argv[i];
+        } else {
+            printf("Usage: %s [--save] [BASELINE]\n", argv[0]);
+            return 1;
+        }
+    }
+    if (save && !baseline_path) {
+        printf("--save needs a baseline file name\n");
+        return 1;
+    }
+
+    const char* sets[] = { "scalar", "sse2", "avx2", "avx512", "vec128" };
+    fill_inputs();
+
+    for (size_t b = 0; b < SDL_arraysize(benches); b++) {
+        if (!benches[b].per_kernel_set) {
+            record(benches[b].name, time_bench(&benches[b]));
+            continue;
+        }
+        for (size_t s = 0; s < SDL_arraysize(sets); s++) {
+            const Kernels* set = find_kernels(sets[s]);
+            if (!set) continue;
+            kernels = set;
+            char name[BENCH_NAME_LEN];
+            snprintf(name, sizeof(name), "%s/%s", benches[b].name, kernels->name);
+            record(name, time_bench(&benches[b]));
+        }
+    }
+
+    Result baseline[BENCH_MAX];
+    int baseline_count = (!save && baseline_path) ? load_baseline(baseline_path, baseline) : 0;
+    if (baseline_path && !save && baseline_count == 0) {
+        printf("No baseline in %s; run `make bench-baseline` to record one.\n", baseline_path);
+    }
+
+    int slower = 0;
+    printf("%-28s %10s %10s %8s\n", "benchmark", "ns/elem", "baseline", "change");
+    for (int i = 0; i < result_count; i++) {
+        const Result* r = &results[i];
+        const Result* base = NULL;
+        for (int k = 0; k < baseline_count; k++) {
+            if (strcmp(baseline[k].name, r->name) == 0) base = &baseline[k];
+        }
+        if (!base) {
+            printf("%-28s %10.3f\n", r->name, r->ns);
+            continue;
+        }
+        double change = (r->ns - base->ns) / base->ns * 100.0;
+        int regressed = change > REGRESSION_PCT;
+        slower += regressed;
+        printf("%-28s %10.3f %10.3f %+7.1f%%%s\n", r->name, r->ns, base->ns, change,
+               regressed ? "  SLOWER" : "");
+    }
+    // The plasma's frame time against 60 fps, on one thread; the demo
+    // spreads the bands over every core
+    for (int i = 0; i < result_count; i++) {
+        if (strncmp(results[i].name, "plasma_1080p/", 13) != 0) continue;
+        double ms = results[i].ns * PLASMA_W * PLASMA_H / 1e6;
+        printf("%s: %.2f ms per frame on one thread, %.0f%% of the 60 fps budget\n",
+               results[i].name, ms, ms / FRAME_BUDGET_MS * 100.0);
+    }
+    if (baseline_count > 0) {
+        printf("%d of %d benchmarks more than %.0f%% slower than the baseline\n",
+               slower, result_count, REGRESSION_PCT);
+    }
+
+    return save ? save_baseline(baseline_path) : 0;
+}
@@ -0,0 +1,163 @@
+/*
+ * capture.c - Frame read-back, hashing and golden file handling.
+ */
+
+#include <SDL.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "capture.h"
+#include "cmdbuf.h"
+#include "tiles.h"
+
+// --- Constants ---
+#define FNV_OFFSET 0xcbf29ce484222325ull
+#define FNV_PRIME 0x100000001b3ull
+
+typedef struct {
+    int frame;
+    Uint64 hash;
+} FrameHash;
+
+// --- Globals ---
+static const char* golden = NULL;
+static int recording = 0;
+static FrameHash* hashes = NULL;
+static int hash_count = 0;
+static int max_captures = 0;
+static int capture_w = 0, capture_h = 0;
+static Uint32* pixels = NULL;
+
+
+int init_capture(const char* golden_path, int record, int frames) {
+    golden = golden_path;
+    recording = record;
+    hash_count = 0;
+    if (!golden) return 0;
+
+    max_captures = frames / CAPTURE_INTERVAL + 1;
+    hashes = malloc(sizeof(FrameHash) * max_captures);
+    if (!hashes) {
+        printf("Could not allocate %d frame hashes\n", max_captures);
+        return 1;
+    }
+    return 0;
+}
+
+// FNV-1a over the colour channels; alpha is whatever the driver leaves there
+static Uint64 hash_pixels(const Uint32* p, int count) {
+    Uint64 h = FNV_OFFSET;
+    for (int i = 0; i < count; i++) {
+        Uint32 c = p[i] & 0x00ffffff;
+        for (int b = 0; b < 3; b++) {
+            h ^= (c >> (8 * b)) & 0xff;
+            h *= FNV_PRIME;
+        }
+    }
+    return h;
+}
+
+// Read back the finished frame; call after drawing, before anything that
+// is not part of the show (the stats overlay) and before presenting
+void capture_frame(SDL_Renderer* renderer, int frame) {
+    if (!golden || frame % CAPTURE_INTERVAL != 0 || hash_count == max_captures) return;
+
+    int w, h;
+    if (SDL_GetRendererOutputSize(renderer, &w, &h) != 0) return;
+    if (!pixels || w != capture_w || h != capture_h) {
+        free(pixels);
+        pixels = malloc(sizeof(Uint32) * w * h);
+        if (!pixels) return;
+        capture_w = w;
+        capture_h = h;
+    }
+
+    cmd_flush(renderer);
+    if (SDL_RenderReadPixels(renderer, NULL, SDL_PIXELFORMAT_ARGB8888, pixels, w * (int)sizeof(Uint32)) != 0) {
+        printf("Could not read back frame %d! SDL_Error: %s\n", frame, SDL_GetError());
+        return;
+    }
+    hashes[hash_count].frame = frame;
+    hashes[hash_count].hash = hash_pixels(pixels, w * h);
+    hash_count++;
+}
+
+static int write_golden(const char* renderer_name) {
+    FILE* f = fopen(golden, "w");
+    if (!f) {
+        printf("Could not write golden file %s\n", golden);
+        return 1;
+    }
+    fprintf(f, "renderer %s %dx%d\n", renderer_name, capture_w, capture_h);
+    for (int i = 0; i < hash_count; i++) {
+        fprintf(f, "%d %016llx\n", hashes[i].frame, (unsigned long long)hashes[i].hash);
+    }
+    fclose(f);
+    printf("Recorded %d frame hashes to %s\n", hash_count, golden);
+    return 0;
+}
+
+static int compare_golden(const char* renderer_name) {
+    FILE* f = fopen(golden, "r");
+    if (!f) {
+        printf("Could not open golden file %s\n", golden);
+        return 1;
+    }
+
+    char name[64];
+    int w, h;
+    if (fscanf(f, "renderer %63s %dx%d", name, &w, &h) != 3) {
+        printf("%s is not a golden file\n", golden);
+        fclose(f);
+        return 1;
+    }
+    if (strcmp(name, renderer_name) != 0 || w != capture_w || h != capture_h) {
+        printf("Golden hashes are for %s at %dx%d, this run is %s at %dx%d\n",
+               name, w, h, renderer_name, capture_w, capture_h);
+        fclose(f);
+        return 1;
+    }
+
+    int checked = 0, mismatched = 0;
+    int frame;
+    unsigned long long expected;
+    while (fscanf(f, "%d %llx", &frame, &expected) == 2) {
+        const FrameHash* got = NULL;
+        for (int i = 0; i < hash_count; i++) {
+            if (hashes[i].frame == frame) got = &hashes[i];
+        }
+        checked++;
+        if (!got) {
+            printf("Frame %d: not captured in this run\n", frame);
+            mismatched++;
+        } else if (got->hash != expected) {
+            printf("Frame %d: hash %016llx, expected %016llx\n",
+                   frame, (unsigned long long)got->hash, expected);
+            mismatched++;
+        }
+    }
+    fclose(f);
+
+    printf("Golden check: %d of %d frames match\n", checked - mismatched, checked);
+    return (mismatched > 0 || checked == 0) ? 1 : 0;
+}
+
+// Record or compare; returns 0 when everything matched
+int finish_capture(SDL_Renderer* renderer) {
+    int result = 0;
+    if (golden) {
+        // The CPU tile path draws differently from the renderer it runs on
+        SDL_RendererInfo info;
+        char renderer_name[64];
+        snprintf(renderer_name, sizeof(renderer_name), "%s%s",
+                 SDL_GetRendererInfo(renderer, &info) == 0 ? info.name : "unknown",
+                 tiles_enabled() ? "+tiles" : "");
+        result = recording ? write_golden(renderer_name) : compare_golden(renderer_name);
+    }
+    free(pixels);
+    free(hashes);
+    pixels = NULL;
+    hashes = NULL;
+    capture_w = capture_h = 0;
+    return result;
+}
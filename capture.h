@@ -0,0 +1,27 @@
+/*
+ * capture.h - Frame hashing and golden-image regression checks.
+ *
+ * In deterministic mode every CAPTURE_INTERVAL-th frame is read back
+ * with SDL_RenderReadPixels and hashed. The hashes are either recorded
+ * to a golden file or compared against one, so a change to the effects
+ * can be shown to be pixel-identical without looking at the screen.
+ *
+ * Hashes depend on the renderer and output size, both of which are
+ * stored in the golden file and checked first. The software renderer
+ * and the CPU tile path give the same pictures on every machine; GPU
+ * drivers may not.
+ */
+
+#ifndef CAPTURE_H
+#define CAPTURE_H
+
+#include <SDL.h>
+
+#define CAPTURE_INTERVAL 30
+
+// frames is the length of the run; every captured frame up to it is kept
+int init_capture(const char* golden_path, int record, int frames);
+void capture_frame(SDL_Renderer* renderer, int frame);
+int finish_capture(SDL_Renderer* renderer);
+
+#endif
@@ -0,0 +1,373 @@
+/*
+ * cmdbuf.c - Per-frame render command buffer.
+ *
+ * Batches are submitted with SDL_RenderGeometry, which carries colour and
+ * alpha per vertex, so fills of any colour that share a blend mode, and
+ * copies of one texture with different colour mods, all collapse into a
+ * single call. Triangles recorded with cmd_triangles() join the fills of
+ * the same blend mode. Older SDL versions fall back to SDL_RenderFillRects
+ * for same-coloured fills, one SDL_RenderCopy per copy and triangle
+ * outlines.
+ */
+
+#include <SDL.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include <string.h>
+#include "cmdbuf.h"
+
+// --- Constants ---
+#define CMD_INITIAL_CAPACITY 1024
+
+#define HAVE_RENDER_GEOMETRY SDL_VERSION_ATLEAST(2, 0, 18)
+
+// --- Structs ---
+typedef struct {
+    int group;
+    int seq; // Recording order, keeps the sort stable
+    SDL_BlendMode blend;
+    SDL_Texture* texture; // NULL for fills
+    SDL_Color color;      // Fill colour or texture modulation
+    SDL_Rect src;
+    SDL_Rect dst;
+    float scale; // Screen space to render target, 1 for whole-target copies
+    int has_src;
+    int first, vertices; // Triangles: range in tri_verts; 0 vertices for rects
+} RenderCmd;
+
+// --- Globals ---
+static RenderCmd* cmds = NULL;
+static int cmd_count = 0;
+static int cmd_capacity = 0;
+static int cmd_group = 0;
+static float cmd_scale = 1.0f;
+
+// Triangle vertices recorded this frame, in view units
+static CmdVertex* tri_verts = NULL;
+static int tri_count = 0;
+static int tri_capacity = 0;
+
+#if HAVE_RENDER_GEOMETRY
+static SDL_Vertex* verts = NULL;
+static int* indices = NULL;
+static int vert_capacity = 0;
+static int index_capacity = 0;
+#endif
+
+static CmdStats frame_stats;
+static CmdStats last_stats;
+
+
+int init_cmdbuf() {
+    cmds = malloc(sizeof(RenderCmd) * CMD_INITIAL_CAPACITY);
+    if (!cmds) {
+        printf("Could not allocate render command buffer\n");
+        return 1;
+    }
+    cmd_capacity = CMD_INITIAL_CAPACITY;
+    cmd_count = 0;
+    return 0;
+}
+
+void cmd_next_group() {
+    cmd_group++;
+}
+
+// Applies to commands recorded from now on
+void cmd_set_scale(float scale) {
+    cmd_scale = scale;
+}
+
+static RenderCmd* push_cmd() {
+    if (cmd_count == cmd_capacity) {
+        int capacity = cmd_capacity ? cmd_capacity * 2 : CMD_INITIAL_CAPACITY;
+        RenderCmd* grown = realloc(cmds, sizeof(RenderCmd) * capacity);
+        if (!grown) return NULL;
+        cmds = grown;
+        cmd_capacity = capacity;
+    }
+    RenderCmd* c = &cmds[cmd_count];
+    c->group = cmd_group;
+    c->seq = cmd_count;
+    c->scale = cmd_scale;
+    c->vertices = 0;
+    cmd_count++;
+    frame_stats.commands++;
+    return c;
+}
+
+void cmd_fill_rect(const SDL_Rect* rect, SDL_Color color, SDL_BlendMode blend) {
+    if (rect->w <= 0 || rect->h <= 0) return;
+    RenderCmd* c = push_cmd();
+    if (!c) return;
+    c->blend = blend;
+    c->texture = NULL;
+    c->color = color;
+    c->dst = *rect;
+    c->has_src = 0;
+}
+
+void cmd_copy(SDL_Texture* texture, const SDL_Rect* src, const SDL_Rect* dst,
+              SDL_Color mod, SDL_BlendMode blend) {
+    RenderCmd* c = push_cmd();
+    if (!c) return;
+    c->blend = blend;
+    c->texture = texture;
+    c->color = mod;
+    c->has_src = src != NULL;
+    if (src) c->src = *src;
+    if (dst) {
+        c->dst = *dst;
+    } else {
+        // Whole render target, resolved at flush time
+        c->scale = 1.0f;
+        c->dst.x = c->dst.y = 0;
+        c->dst.w = c->dst.h = -1;
+    }
+}
+
+// Untextured triangle list, three vertices per triangle
+void cmd_triangles(const CmdVertex* vertices, int count, SDL_BlendMode blend) {
+    count -= count % 3;
+    if (count <= 0) return;
+    if (tri_count + count > tri_capacity) {
+        int capacity = tri_capacity ? tri_capacity : CMD_INITIAL_CAPACITY * 4;
+        while (capacity < tri_count + count) capacity *= 2;
+        CmdVertex* grown = realloc(tri_verts, sizeof(CmdVertex) * capacity);
+        if (!grown) return;
+        tri_verts = grown;
+        tri_capacity = capacity;
+    }
+    RenderCmd* c = push_cmd();
+    if (!c) return;
+    c->blend = blend;
+    c->texture = NULL;
+    c->has_src = 0;
+    c->first = tri_count;
+    c->vertices = count;
+    memcpy(tri_verts + tri_count, vertices, sizeof(CmdVertex) * count);
+    tri_count += count;
+}
+
+// Group first, then blend mode and texture, then recording order
+static int compare_cmds(const void* pa, const void* pb) {
+    const RenderCmd* a = pa;
+    const RenderCmd* b = pb;
+    if (a->group != b->group) return a->group < b->group ? -1 : 1;
+    if (a->blend != b->blend) return a->blend < b->blend ? -1 : 1;
+    if (a->texture != b->texture) return (uintptr_t)a->texture < (uintptr_t)b->texture ? -1 : 1;
+    return a->seq < b->seq ? -1 : (a->seq > b->seq);
+}
+
+static int same_state(const RenderCmd* a, const RenderCmd* b) {
+    return a->blend == b->blend && a->texture == b->texture;
+}
+
+// Resolve "whole target" destinations now that we know the output size
+static void resolve_dst(SDL_Renderer* renderer, RenderCmd* c) {
+    if (c->dst.w < 0) {
+        SDL_Texture* target = SDL_GetRenderTarget(renderer);
+        if (target) {
+            SDL_QueryTexture(target, NULL, NULL, &c->dst.w, &c->dst.h);
+        } else {
+            SDL_GetRendererOutputSize(renderer, &c->dst.w, &c->dst.h);
+        }
+    }
+}
+
+#if HAVE_RENDER_GEOMETRY
+static int reserve_vertices(int count, int index_count) {
+    if (count > vert_capacity) {
+        int capacity = vert_capacity ? vert_capacity : CMD_INITIAL_CAPACITY * 4;
+        while (capacity < count) capacity *= 2;
+        SDL_Vertex* v = realloc(verts, sizeof(SDL_Vertex) * capacity);
+        if (!v) return 0;
+        verts = v;
+        vert_capacity = capacity;
+    }
+    if (index_count > index_capacity) {
+        int capacity = index_capacity ? index_capacity : CMD_INITIAL_CAPACITY * 6;
+        while (capacity < index_count) capacity *= 2;
+        int* idx = realloc(indices, sizeof(int) * capacity);
+        if (!idx) return 0;
+        indices = idx;
+        index_capacity = capacity;
+    }
+    return 1;
+}
+
+// Submit a run of commands that share blend mode and texture as one call
+static void submit_batch(SDL_Renderer* renderer, RenderCmd* run, int count) {
+    int vertex_count = 0, index_count = 0;
+    for (int i = 0; i < count; i++) {
+        vertex_count += run[i].vertices ? run[i].vertices : 4;
+        index_count += run[i].vertices ? run[i].vertices : 6;
+    }
+    if (!reserve_vertices(vertex_count, index_count)) return;
+
+    int tex_w = 1, tex_h = 1;
+    if (run[0].texture) {
+        SDL_QueryTexture(run[0].texture, NULL, NULL, &tex_w, &tex_h);
+        SDL_SetTextureBlendMode(run[0].texture, run[0].blend);
+        // Modulation comes from the vertex colours
+        SDL_SetTextureColorMod(run[0].texture, 255, 255, 255);
+        SDL_SetTextureAlphaMod(run[0].texture, 255);
+    } else {
+        SDL_SetRenderDrawBlendMode(renderer, run[0].blend);
+    }
+
+    int nv = 0, ni = 0;
+    for (int i = 0; i < count; i++) {
+        RenderCmd* c = &run[i];
+        if (c->vertices) {
+            for (int k = 0; k < c->vertices; k++) {
+                const CmdVertex* t = &tri_verts[c->first + k];
+                verts[nv + k] = (SDL_Vertex){ { t->x * c->scale, t->y * c->scale }, t->color, { 0.0f, 0.0f } };
+                indices[ni + k] = nv + k;
+            }
+            nv += c->vertices;
+            ni += c->vertices;
+            continue;
+        }
+        resolve_dst(renderer, c);
+        float x0 = c->dst.x * c->scale, y0 = c->dst.y * c->scale;
+        float x1 = (c->dst.x + c->dst.w) * c->scale, y1 = (c->dst.y + c->dst.h) * c->scale;
+        float u0 = 0.0f, v0 = 0.0f, u1 = 1.0f, v1 = 1.0f;
+        if (c->has_src) {
+            u0 = (float)c->src.x / tex_w;
+            v0 = (float)c->src.y / tex_h;
+            u1 = (float)(c->src.x + c->src.w) / tex_w;
+            v1 = (float)(c->src.y + c->src.h) / tex_h;
+        }
+
+        SDL_Vertex* v = &verts[nv];
+        v[0] = (SDL_Vertex){ { x0, y0 }, c->color, { u0, v0 } };
+        v[1] = (SDL_Vertex){ { x1, y0 }, c->color, { u1, v0 } };
+        v[2] = (SDL_Vertex){ { x1, y1 }, c->color, { u1, v1 } };
+        v[3] = (SDL_Vertex){ { x0, y1 }, c->color, { u0, v1 } };
+
+        int* idx = &indices[ni];
+        idx[0] = nv; idx[1] = nv + 1; idx[2] = nv + 2;
+        idx[3] = nv; idx[4] = nv + 2; idx[5] = nv + 3;
+        nv += 4;
+        ni += 6;
+    }
+
+    SDL_RenderGeometry(renderer, run[0].texture, verts, nv, indices, ni);
+    frame_stats.batches++;
+}
+#else
+static SDL_Rect scale_rect(const SDL_Rect* r, float scale) {
+    int x0 = (int)(r->x * scale), y0 = (int)(r->y * scale);
+    int x1 = (int)((r->x + r->w) * scale), y1 = (int)((r->y + r->h) * scale);
+    SDL_Rect out = { x0, y0, x1 - x0, y1 - y0 };
+    return out;
+}
+
+// Triangles can only be outlined, in their first vertex's colour
+static void draw_outlines(SDL_Renderer* renderer, const RenderCmd* c) {
+    for (int i = 0; i < c->vertices; i += 3) {
+        const CmdVertex* v = &tri_verts[c->first + i];
+        SDL_Point p[4];
+        for (int k = 0; k < 4; k++) {
+            p[k].x = (int)(v[k % 3].x * c->scale);
+            p[k].y = (int)(v[k % 3].y * c->scale);
+        }
+        SDL_SetRenderDrawColor(renderer, v->color.r, v->color.g, v->color.b, v->color.a);
+        SDL_RenderDrawLines(renderer, p, 4);
+        frame_stats.batches++;
+    }
+}
+
+// Without geometry support, fills batch per colour and copies go one by one
+static void submit_batch(SDL_Renderer* renderer, RenderCmd* run, int count) {
+    if (run[0].texture) {
+        SDL_SetTextureBlendMode(run[0].texture, run[0].blend);
+        for (int i = 0; i < count; i++) {
+            RenderCmd* c = &run[i];
+            resolve_dst(renderer, c);
+            SDL_SetTextureColorMod(c->texture, c->color.r, c->color.g, c->color.b);
+            SDL_SetTextureAlphaMod(c->texture, c->color.a);
+            SDL_Rect dst = scale_rect(&c->dst, c->scale);
+            SDL_RenderCopy(renderer, c->texture, c->has_src ? &c->src : NULL, &dst);
+            frame_stats.batches++;
+        }
+        return;
+    }
+
+    SDL_SetRenderDrawBlendMode(renderer, run[0].blend);
+    SDL_Rect rects[256];
+    int i = 0;
+    while (i < count) {
+        if (run[i].vertices) {
+            draw_outlines(renderer, &run[i]);
+            i++;
+            continue;
+        }
+        SDL_Color col = run[i].color;
+        int n = 0;
+        while (i < count && n < 256 && !run[i].vertices && run[i].color.r == col.r && run[i].color.g == col.g &&
+               run[i].color.b == col.b && run[i].color.a == col.a) {
+            rects[n++] = scale_rect(&run[i].dst, run[i].scale);
+            i++;
+        }
+        SDL_SetRenderDrawColor(renderer, col.r, col.g, col.b, col.a);
+        SDL_RenderFillRects(renderer, rects, n);
+        frame_stats.batches++;
+    }
+}
+#endif
+
+// Sort the recorded commands and submit them in as few batches as possible
+void cmd_flush(SDL_Renderer* renderer) {
+    if (cmd_count == 0) return;
+
+    qsort(cmds, cmd_count, sizeof(RenderCmd), compare_cmds);
+
+    int i = 0;
+    while (i < cmd_count) {
+        int j = i + 1;
+        while (j < cmd_count && same_state(&cmds[i], &cmds[j])) j++;
+        if (i > 0) frame_stats.state_changes++;
+        submit_batch(renderer, &cmds[i], j - i);
+        i = j;
+    }
+
+    // Later draws outside the buffer expect blending to be off again
+    SDL_SetRenderDrawBlendMode(renderer, SDL_BLENDMODE_NONE);
+    cmd_count = 0;
+    cmd_group = 0;
+    tri_count = 0;
+}
+
+// Final flush of the frame, then present it
+void cmd_present(SDL_Renderer* renderer) {
+    cmd_flush(renderer);
+    SDL_RenderPresent(renderer);
+    last_stats = frame_stats;
+    frame_stats.commands = 0;
+    frame_stats.batches = 0;
+    frame_stats.state_changes = 0;
+}
+
+// Figures for the last presented frame
+void get_cmd_stats(CmdStats* out) {
+    *out = last_stats;
+}
+
+void cleanup_cmdbuf() {
+    free(cmds);
+    cmds = NULL;
+    cmd_count = cmd_capacity = 0;
+    free(tri_verts);
+    tri_verts = NULL;
+    tri_count = tri_capacity = 0;
+#if HAVE_RENDER_GEOMETRY
+    free(verts);
+    free(indices);
+    verts = NULL;
+    indices = NULL;
+    vert_capacity = index_capacity = 0;
+#endif
+}
@@ -0,0 +1,46 @@
+/*
+ * cmdbuf.h - Per-frame render command buffer.
+ *
+ * Effects record fills and texture copies here instead of calling the
+ * SDL draw functions directly. On flush the commands are sorted by blend
+ * mode and texture within each group and runs that share the same state
+ * are submitted as one batch.
+ *
+ * Commands in the same group may be reordered, so start a new group with
+ * cmd_next_group() whenever later draws must land on top of earlier ones.
+ * The timeline starts a new group for every effect.
+ *
+ * Coordinates are given in view units; cmd_set_scale() maps them to pixels
+ * of the current render target.
+ */
+
+#ifndef CMDBUF_H
+#define CMDBUF_H
+
+#include <SDL.h>
+
+typedef struct {
+    int commands;      // Commands recorded
+    int batches;       // Draw submissions made to SDL
+    int state_changes; // Blend mode / texture switches between batches
+} CmdStats;
+
+// Corner of an untextured triangle for cmd_triangles(), in view units
+typedef struct {
+    float x, y;
+    SDL_Color color;
+} CmdVertex;
+
+int init_cmdbuf();
+void cmd_next_group();
+void cmd_set_scale(float scale);
+void cmd_fill_rect(const SDL_Rect* rect, SDL_Color color, SDL_BlendMode blend);
+void cmd_copy(SDL_Texture* texture, const SDL_Rect* src, const SDL_Rect* dst,
+              SDL_Color mod, SDL_BlendMode blend);
+void cmd_triangles(const CmdVertex* vertices, int count, SDL_BlendMode blend);
+void cmd_flush(SDL_Renderer* renderer);
+void cmd_present(SDL_Renderer* renderer);
+void get_cmd_stats(CmdStats* out);
+void cleanup_cmdbuf();
+
+#endif
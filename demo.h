@@ -0,0 +1,29 @@
+/*
+ * demo.h - Shared constants and globals for the scroller demo.
+ */
+
+#ifndef DEMO_H
+#define DEMO_H
+
+#include <SDL.h>
+#include <SDL_ttf.h>
+
+// --- Constants ---
+#define DEFAULT_WIDTH 800
+#define DEFAULT_HEIGHT 600
+#define VIEW_HEIGHT 600         // Effects lay out in units of 1/600th of the window height
+#define FRAME_DT (1.0f / 60.0f) // Simulation step, seconds
+#define DEMO_SEED 1             // rand() seed in deterministic mode
+
+// --- Globals (main.c) ---
+extern SDL_Window* window;
+extern SDL_Renderer* renderer;
+extern TTF_Font* font;
+
+// Output size, updated by the main thread and readable from any thread
+int screen_width();     // Pixels
+int screen_height();    // Pixels
+int view_width();       // Layout units across the window (VIEW_HEIGHT tall)
+float view_to_pixels(); // Pixels per layout unit
+
+#endif
@@ -0,0 +1,459 @@
+/*
+ * effect.c - Timeline sequencer and layer compositor for the effect modules.
+ *
+ * update_timeline() and publish_timeline() belong to the simulation thread,
+ * render_timeline() and the stats getters to the main thread; the only
+ * thing they share is the snapshot handed over by sim.c.
+ *
+ * Below a render scale of 1 the whole show, layers included, is drawn into
+ * a smaller scene texture that is then stretched over the window with
+ * nearest or linear filtering.
+ *
+ * On the CPU framebuffer path (tiles.h) none of the render targets exist:
+ * every tile runs all active effects' render_tile() hooks on the job pool
+ * and the finished frame is copied to the window as one texture.
+ */
+
+#include <SDL.h>
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "demo.h"
+#include "effect.h"
+#include "cmdbuf.h"
+#include "jobs.h"
+#include "tiles.h"
+
+// --- Constants ---
+#define TRAIL_STEP 2 // Colour levels per 1/60 s a trail fade takes off on top of the multiply
+
+// --- Globals ---
+static Effect* effects[TIMELINE_MAX_EFFECTS];
+static int effect_count = 0;
+static int initialized_count = 0;
+static const Cue* cues = NULL;
+static int cue_count = 0;
+static float show_length = 0.0f;
+static float show_time = 0.0f;
+static int active_count = 0;
+static size_t views_size = 0;
+
+// Main thread
+static const TimelineSnapshot* current = NULL;
+static LayerStats layer_stats;
+static int render_targets = 0;
+static SDL_BlendMode trail_fade = SDL_BLENDMODE_BLEND;
+static Uint8 trail_step = 0;
+static float render_scale = 1.0f;
+static SDL_Texture* scene = NULL;
+static int scene_linear = 1;
+
+
+// (Re)create the layers and scene texture at the current internal resolution
+static int create_render_targets(SDL_Renderer* renderer) {
+    if (!render_targets || tiles_enabled()) return 0;
+
+    int w = (int)(screen_width() * render_scale);
+    int h = (int)(screen_height() * render_scale);
+    if (w < 1) w = 1;
+    if (h < 1) h = 1;
+
+    if (scene) SDL_DestroyTexture(scene);
+    scene = NULL;
+    if (render_scale < 1.0f) {
+        // Older SDL only reads the filter from the hint at creation time
+        SDL_SetHint(SDL_HINT_RENDER_SCALE_QUALITY, scene_linear ? "linear" : "nearest");
+        scene = SDL_CreateTexture(renderer, SDL_PIXELFORMAT_ARGB8888, SDL_TEXTUREACCESS_TARGET, w, h);
+        SDL_SetHint(SDL_HINT_RENDER_SCALE_QUALITY, "nearest");
+        if (!scene) {
+            printf("Could not create scene texture! SDL_Error: %s\n", SDL_GetError());
+            return 1;
+        }
+#if SDL_VERSION_ATLEAST(2, 0, 12)
+        SDL_SetTextureScaleMode(scene, scene_linear ? SDL_ScaleModeLinear : SDL_ScaleModeNearest);
+#endif
+    }
+
+    for (int i = 0; i < effect_count; i++) {
+        Effect* fx = effects[i];
+        if (!fx->layered) continue;
+        if (fx->layer) SDL_DestroyTexture(fx->layer);
+        fx->layer = SDL_CreateTexture(renderer, SDL_PIXELFORMAT_ARGB8888, SDL_TEXTUREACCESS_TARGET, w, h);
+        if (!fx->layer) {
+            printf("Could not create layer for '%s'! SDL_Error: %s\n", fx->name, SDL_GetError());
+            return 1;
+        }
+        SDL_SetTextureBlendMode(fx->layer, SDL_BLENDMODE_BLEND);
+        fx->layer_version = (Uint32)-1; // Never matches a published version: redraw
+    }
+    return 0;
+}
+
+// Trail fade: dst * (1 - a) - step. Taking a small step off as well lets
+// faint streaks reach black, where 8-bit rounding would stall a plain
+// multiply. Renderers without custom blend modes fall back to the multiply
+static void init_trail_fade(SDL_Renderer* renderer) {
+    trail_fade = SDL_BLENDMODE_BLEND;
+    trail_step = 0;
+#if SDL_VERSION_ATLEAST(2, 0, 6)
+    SDL_BlendMode fade = SDL_ComposeCustomBlendMode(SDL_BLENDFACTOR_ONE, SDL_BLENDFACTOR_ONE_MINUS_SRC_ALPHA,
+                                                    SDL_BLENDOPERATION_REV_SUBTRACT, SDL_BLENDFACTOR_ONE,
+                                                    SDL_BLENDFACTOR_ONE, SDL_BLENDOPERATION_ADD);
+    if (SDL_SetRenderDrawBlendMode(renderer, fade) == 0) {
+        trail_fade = fade;
+        trail_step = TRAIL_STEP;
+    }
+    SDL_SetRenderDrawBlendMode(renderer, SDL_BLENDMODE_NONE);
+#endif
+}
+
+// Change the internal resolution; a no-op when it is unchanged
+int set_render_scale(SDL_Renderer* renderer, float scale) {
+    if (scale == render_scale) return 0;
+    render_scale = scale;
+    // The CPU framebuffer follows the scale directly, so its effects see a resize
+    if (tiles_enabled()) return resize_timeline(renderer);
+    return create_render_targets(renderer);
+}
+
+// Filter used when stretching the scene; takes effect with the next scale change
+void set_scale_filter(int linear) {
+    scene_linear = linear;
+}
+
+int get_scale_filter() {
+    return scene_linear;
+}
+
+// The window changed size: rebuild render targets and size-dependent caches
+int resize_timeline(SDL_Renderer* renderer) {
+    if (create_render_targets(renderer) != 0) return 1;
+    for (int i = 0; i < effect_count; i++) {
+        if (effects[i]->resize) effects[i]->resize(effects[i], renderer);
+    }
+    return 0;
+}
+
+float get_render_scale() {
+    return (render_targets || tiles_enabled()) ? render_scale : 1.0f;
+}
+
+// Initialize every effect in the show up front so activation never stalls
+int init_timeline(SDL_Renderer* renderer, Effect** fx_list, int count,
+                  const Cue* cue_list, int cues_in_list, float length) {
+    if (count > TIMELINE_MAX_EFFECTS) {
+        printf("Too many effects in the show (%d, max %d)\n", count, TIMELINE_MAX_EFFECTS);
+        return 1;
+    }
+    effect_count = count;
+    cues = cue_list;
+    cue_count = cues_in_list;
+    show_length = length;
+    show_time = 0.0f;
+
+    render_targets = SDL_RenderTargetSupported(renderer);
+    init_trail_fade(renderer);
+    for (int i = 0; i < count; i++) {
+        Effect* fx = fx_list[i];
+        effects[i] = fx;
+        fx->active = 0;
+        fx->entered = 0;
+        fx->alpha = 0.0f;
+        fx->layered = 0;
+        fx->layer = NULL;
+        fx->view = NULL;
+        fx->view_size = 0;
+        fx->version = 0;
+        fx->layer_version = 0;
+        fx->layer_time = 0.0f;
+        fx->layer_trailed = 0;
+        fx->table_bytes = 0;
+        fx->tint = (SDL_Color){ 255, 255, 255, 255 };
+        fx->trail = 0.0f;
+        initialized_count = i + 1; // destroy() must also cope with a half-done init
+        if (fx->init && fx->init(fx, renderer) != 0) {
+            printf("Effect '%s' failed to initialize\n", fx->name);
+            return 1;
+        }
+
+        if (fx->layered) fx->dirty = 1;
+        views_size += fx->view_size;
+    }
+    return resize_timeline(renderer);
+}
+
+// Fade weight of a cue at time t, 0 when outside it
+static float cue_weight(const Cue* c, float t) {
+    if (t < c->start || t >= c->end) return 0.0f;
+    float w = 1.0f;
+    if (c->fade_in > 0.0f && t - c->start < c->fade_in) {
+        w = (t - c->start) / c->fade_in;
+    }
+    if (c->fade_out > 0.0f && c->end - t < c->fade_out) {
+        float out = (c->end - t) / c->fade_out;
+        if (out < w) w = out;
+    }
+    return w;
+}
+
+// Work out which effects are on screen, then advance only those
+void update_timeline(float dt) {
+    show_time += dt;
+    if (show_length > 0.0f && show_time >= show_length) {
+        show_time -= show_length;
+    }
+
+    int was_active[TIMELINE_MAX_EFFECTS];
+    for (int i = 0; i < effect_count; i++) {
+        was_active[i] = effects[i]->active;
+        effects[i]->active = 0;
+        effects[i]->alpha = 0.0f;
+    }
+
+    // Where cues for the same effect overlap, the strongest one wins
+    for (int i = 0; i < cue_count; i++) {
+        const Cue* c = &cues[i];
+        float w = cue_weight(c, show_time);
+        if (w <= 0.0f || w <= c->fx->alpha) continue;
+
+        float span = c->end - c->start;
+        float p = span > 0.0f ? (show_time - c->start) / span : 0.0f;
+        c->fx->active = 1;
+        c->fx->alpha = w;
+        for (int k = 0; k < EFFECT_PARAMS; k++) {
+            c->fx->params[k] = c->from[k] + (c->to[k] - c->from[k]) * p;
+        }
+    }
+
+    active_count = 0;
+    for (int i = 0; i < effect_count; i++) {
+        if (!effects[i]->active) continue;
+        active_count++;
+        effects[i]->entered = !was_active[i];
+        if (effects[i]->update) effects[i]->update(effects[i], dt);
+    }
+}
+
+TimelineSnapshot* create_timeline_snapshot() {
+    TimelineSnapshot* snap = calloc(1, sizeof(TimelineSnapshot));
+    if (!snap) return NULL;
+    snap->views = malloc(views_size > 0 ? views_size : 1);
+    if (!snap->views) {
+        free(snap);
+        return NULL;
+    }
+    return snap;
+}
+
+void destroy_timeline_snapshot(TimelineSnapshot* snap) {
+    if (!snap) return;
+    free(snap->views);
+    free(snap);
+}
+
+// Capture the timeline state and every active effect's view
+void publish_timeline(TimelineSnapshot* snap) {
+    unsigned char* out = snap->views;
+
+    snap->show_time = show_time;
+    snap->active_count = active_count;
+    for (int i = 0; i < effect_count; i++) {
+        Effect* fx = effects[i];
+        EffectFrame* f = &snap->frames[i];
+
+        if (fx->dirty) {
+            fx->version++;
+            fx->dirty = 0;
+        }
+        f->active = fx->active;
+        f->alpha = fx->alpha;
+        memcpy(f->params, fx->params, sizeof(f->params));
+        f->tint = fx->tint;
+        f->trail = fx->trail;
+        f->version = fx->version;
+        f->view = NULL;
+        if (fx->view_size > 0) {
+            if (fx->active) memcpy(out, fx->view, fx->view_size);
+            f->view = out;
+            out += fx->view_size;
+        }
+    }
+}
+
+// Redraw a layer into its cached texture. A layer with a trail keeps its
+// old picture under a single full-layer fade, unless it is fresh. The fade
+// follows the show time since the last redraw, so streaks are as long at
+// any refresh rate
+static void redraw_layer(Effect* fx, const EffectFrame* frame, SDL_Renderer* renderer, float time) {
+    SDL_Texture* previous = SDL_GetRenderTarget(renderer);
+    SDL_SetRenderTarget(renderer, fx->layer);
+    float elapsed = time - fx->layer_time;
+    if (elapsed < 0.0f) elapsed += show_length; // The show looped
+    fx->layer_time = time;
+    fx->layer_trailed = frame->trail > 0.0f;
+    if (frame->trail > 0.0f && fx->layer_version != (Uint32)-1) {
+        // One unit over, so rounding in the scale cannot leave an edge unfaded
+        SDL_Rect all = { 0, 0, view_width() + 1, VIEW_HEIGHT + 1 };
+        float steps = elapsed / FRAME_DT;
+        float kept = powf(frame->trail, steps);
+        Uint8 step = trail_step ? (Uint8)SDL_max(1.0f, SDL_min(trail_step * steps + 0.5f, 255.0f)) : 0;
+        SDL_Color fade = { step, step, step, (Uint8)(255 * (1.0f - kept) + 0.5f) };
+        cmd_fill_rect(&all, fade, trail_fade);
+        cmd_next_group();
+    } else {
+        SDL_SetRenderDrawBlendMode(renderer, SDL_BLENDMODE_NONE);
+        SDL_SetRenderDrawColor(renderer, 0, 0, 0, 0);
+        SDL_RenderClear(renderer);
+    }
+    fx->render(fx, frame, renderer);
+    cmd_flush(renderer);
+    SDL_SetRenderTarget(renderer, previous);
+    fx->layer_version = frame->version;
+}
+
+// Draw every active effect into one tile, back to front
+static void draw_tile(void* ctx, int index) {
+    const TimelineSnapshot* snap = ctx;
+    Tile tile;
+    get_tile(index, &tile);
+    tile_clear(&tile, 0xff000000);
+    for (int i = 0; i < effect_count; i++) {
+        Effect* fx = effects[i];
+        const EffectFrame* f = &snap->frames[i];
+        if (f->active && fx->render_tile) fx->render_tile(fx, f, &tile);
+    }
+}
+
+// Rasterize the frame on the CPU and queue it as a single copy
+static void render_timeline_tiles(SDL_Renderer* renderer, const TimelineSnapshot* snap) {
+    float scale = get_render_scale();
+    int w = (int)(screen_width() * scale);
+    int h = (int)(screen_height() * scale);
+    if (begin_tiles(renderer, w, h, view_to_pixels() * scale, scene_linear) != 0) return;
+
+    for (int i = 0; i < effect_count; i++) {
+        if (snap->frames[i].active && effects[i]->render_tile) layer_stats.direct++;
+    }
+    run_jobs(draw_tile, (void*)snap, tile_count());
+
+    SDL_Texture* frame = end_tiles(renderer);
+    SDL_Color white = { 255, 255, 255, 255 };
+    cmd_next_group();
+    cmd_copy(frame, NULL, NULL, white, SDL_BLENDMODE_NONE);
+}
+
+// Record the active effects back to front, reusing clean layers.
+// Dirty layers are redrawn (and flushed) first, so the screen commands
+// recorded afterwards all go to the same render target.
+void render_timeline(SDL_Renderer* renderer, const TimelineSnapshot* snap) {
+    current = snap;
+    layer_stats.cached = 0;
+    layer_stats.redrawn = 0;
+    layer_stats.direct = 0;
+
+    for (int i = 0; i < effect_count; i++) {
+        const EffectFrame* f = &snap->frames[i];
+        if (f->active && effects[i]->prepare) effects[i]->prepare(effects[i], f);
+    }
+
+    if (tiles_enabled()) {
+        render_timeline_tiles(renderer, snap);
+        return;
+    }
+    if (scene) {
+        SDL_SetRenderTarget(renderer, scene);
+        SDL_SetRenderDrawColor(renderer, 0, 0, 0, 255);
+        SDL_RenderClear(renderer);
+    }
+    cmd_set_scale(view_to_pixels() * get_render_scale());
+
+    for (int i = 0; i < effect_count; i++) {
+        Effect* fx = effects[i];
+        const EffectFrame* f = &snap->frames[i];
+        if (!fx->render || !fx->layer) continue;
+        if (!f->active) {
+            // Trails from the last time on screen would come back stale
+            if (fx->layer_trailed) fx->layer_version = (Uint32)-1;
+            continue;
+        }
+        // A fresh layer starts at version 0 but was marked dirty, so the
+        // first published version is always at least 1
+        if (f->version != fx->layer_version) {
+            redraw_layer(fx, f, renderer, snap->show_time);
+            layer_stats.redrawn++;
+        } else {
+            layer_stats.cached++;
+        }
+    }
+
+    for (int i = 0; i < effect_count; i++) {
+        Effect* fx = effects[i];
+        const EffectFrame* f = &snap->frames[i];
+        if (!f->active || !fx->render) continue;
+
+        cmd_next_group();
+        if (!fx->layer) {
+            fx->render(fx, f, renderer);
+            layer_stats.direct++;
+            continue;
+        }
+        SDL_Color mod = { f->tint.r, f->tint.g, f->tint.b, (Uint8)(255 * f->alpha) };
+        // Faded trails are dark rather than transparent, so they are added
+        cmd_copy(fx->layer, NULL, NULL, mod, f->trail > 0.0f ? SDL_BLENDMODE_ADD : SDL_BLENDMODE_BLEND);
+    }
+
+    // Upscale the finished scene to the window
+    cmd_set_scale(1.0f);
+    if (scene) {
+        cmd_flush(renderer);
+        SDL_SetRenderTarget(renderer, NULL);
+        SDL_Color white = { 255, 255, 255, 255 };
+        cmd_next_group();
+        cmd_copy(scene, NULL, NULL, white, SDL_BLENDMODE_NONE);
+    }
+}
+
+// Figures for the snapshot last drawn
+int timeline_active_count() {
+    return current ? current->active_count : 0;
+}
+
+int timeline_effect_count() {
+    return effect_count;
+}
+
+float timeline_time() {
+    return current ? current->show_time : 0.0f;
+}
+
+float timeline_length() {
+    return show_length;
+}
+
+size_t timeline_table_bytes() {
+    size_t bytes = 0;
+    for (int i = 0; i < effect_count; i++) bytes += effects[i]->table_bytes;
+    return bytes;
+}
+
+void get_layer_stats(LayerStats* out) {
+    *out = layer_stats;
+}
+
+void cleanup_timeline() {
+    for (int i = 0; i < initialized_count; i++) {
+        if (effects[i]->destroy) effects[i]->destroy(effects[i]);
+        if (effects[i]->layer) SDL_DestroyTexture(effects[i]->layer);
+        effects[i]->state = NULL;
+        effects[i]->layer = NULL;
+    }
+    effect_count = 0;
+    initialized_count = 0;
+    views_size = 0;
+    current = NULL;
+    if (scene) SDL_DestroyTexture(scene);
+    scene = NULL;
+    render_scale = 1.0f;
+    cleanup_tiles();
+}
@@ -0,0 +1,176 @@
+/*
+ * effect.h - Effect module interface and timeline sequencer.
+ *
+ * Every visual effect is an Effect with its own state and init/update/
+ * render/destroy hooks. The timeline activates effects from a list of
+ * cues, fades them in and out and interpolates their parameters; effects
+ * that no cue covers are neither updated nor rendered.
+ *
+ * An effect can ask for its own layer: it then renders into a cached
+ * target texture that is only redrawn when the effect marks itself dirty,
+ * and the crossfade alpha and tint are applied when the layer is
+ * composited. Layered effects must therefore draw at full opacity and
+ * leave alpha to the compositor; a layer starts out fully transparent.
+ * With a trail set, a redraw fades the previous picture instead of
+ * clearing it and the layer is added over the scene, so whatever moved
+ * leaves a streak behind at the cost of one full-layer blend.
+ *
+ * Effects draw by recording into the command buffer (cmdbuf.h); each
+ * effect gets its own command group.
+ *
+ * update() runs on the simulation thread (sim.c) and render() on the main
+ * thread. Everything render() needs that update() changes must live in the
+ * effect's view: a plain struct the effect points `view` at in init(). The
+ * timeline copies each view into an immutable snapshot after every step,
+ * and render() only ever reads the snapshot through its EffectFrame.
+ *
+ * Effects lay out in view units: VIEW_HEIGHT tall and view_width() wide
+ * (see demo.h). The command buffer maps them to pixels. The optional
+ * resize() hook runs on the main thread after the window size changed, and
+ * on the CPU path also after the render scale changed. It should rebuild
+ * only the effect's size-dependent caches.
+ *
+ * With the CPU framebuffer on (tiles.h) render() is not used; the
+ * timeline calls render_tile() for every tile instead, from several
+ * threads at once. There are no layers on that path, so render_tile()
+ * applies the frame's alpha and tint itself. Effects without the hook
+ * are not drawn there.
+ *
+ * The optional prepare() hook runs on the main thread once per drawn
+ * frame, on both paths, before anything is drawn. It is the place for
+ * render-side work that all tiles share, and it may use the job pool.
+ */
+
+#ifndef EFFECT_H
+#define EFFECT_H
+
+#include <SDL.h>
+#include <math.h>
+#include "tiles.h"
+
+#define EFFECT_PARAMS 4
+#define TIMELINE_MAX_EFFECTS 32
+
+typedef struct Effect Effect;
+
+// An effect's timeline state and view as captured in one snapshot
+typedef struct {
+    int active;
+    float alpha;
+    float params[EFFECT_PARAMS];
+    SDL_Color tint;
+    float trail;      // Share of the layer kept per 1/60 s, 0 clears it on every redraw
+    Uint32 version;   // Changes whenever the layer content changed
+    const void* view; // Copy of the effect's view, NULL if it has none
+} EffectFrame;
+
+struct Effect {
+    const char* name;
+    int (*init)(Effect* fx, SDL_Renderer* renderer);
+    void (*update)(Effect* fx, float dt);
+    void (*render)(Effect* fx, const EffectFrame* frame, SDL_Renderer* renderer);
+    void (*destroy)(Effect* fx);
+    void (*resize)(Effect* fx, SDL_Renderer* renderer);
+    void (*render_tile)(Effect* fx, const EffectFrame* frame, const Tile* tile);
+    void (*prepare)(Effect* fx, const EffectFrame* frame);
+    void* state;
+
+    // Render-side data published every step, set up by the effect in init()
+    const void* view;
+    size_t view_size;
+
+    // Written by the timeline every step (simulation thread)
+    int active;
+    int entered;                 // Set for the first update after coming on screen
+    float alpha;                 // Crossfade weight, 0..1
+    float params[EFFECT_PARAMS]; // Meaning is defined by each effect
+
+    // Layer caching, set up by the effect in init()
+    int layered;       // Render into a cached layer instead of straight to the screen
+    int dirty;         // Set by the effect whenever its layer content changes
+    SDL_Color tint;    // Colour modulation applied when compositing (white by default)
+    float trail;       // Share of the old layer kept per 1/60 s, 0..1 (0 by default)
+    Uint32 version;    // Bumped by the timeline when a dirty effect is published
+    SDL_Texture* layer;
+    Uint32 layer_version; // Version the layer was last drawn from (main thread)
+    float layer_time;     // Show time of that redraw, for trail fades (main thread)
+    int layer_trailed;    // The layer holds faded trails (main thread)
+
+    // Memory held in size-dependent lookup tables, for the stats overlay (main thread)
+    size_t table_bytes;
+};
+
+// Everything the main thread needs to draw one frame
+typedef struct {
+    float show_time;
+    int active_count;
+    EffectFrame frames[TIMELINE_MAX_EFFECTS];
+    unsigned char* views; // Backing store for the frames' view copies
+} TimelineSnapshot;
+
+// Per-frame compositor counters
+typedef struct {
+    int cached;  // Layers composited straight from cache
+    int redrawn; // Layers re-rendered because they were dirty
+    int direct;  // Effects drawn straight to the screen
+} LayerStats;
+
+// One span of an effect on the timeline (times in seconds)
+typedef struct {
+    Effect* fx;
+    float start, end;
+    float fade_in, fade_out;
+    float from[EFFECT_PARAMS]; // Parameters at start...
+    float to[EFFECT_PARAMS];   // ...interpolated linearly to these at end
+} Cue;
+
+// Effects are drawn in the order given; the show loops after `length` seconds
+int init_timeline(SDL_Renderer* renderer, Effect** effects, int count,
+                  const Cue* cues, int cue_count, float length);
+void update_timeline(float dt);
+TimelineSnapshot* create_timeline_snapshot();
+void publish_timeline(TimelineSnapshot* snap);
+void destroy_timeline_snapshot(TimelineSnapshot* snap);
+void render_timeline(SDL_Renderer* renderer, const TimelineSnapshot* snap);
+int timeline_active_count();
+int timeline_effect_count();
+float timeline_time();
+float timeline_length();
+size_t timeline_table_bytes();
+void get_layer_stats(LayerStats* out);
+int resize_timeline(SDL_Renderer* renderer);
+int set_render_scale(SDL_Renderer* renderer, float scale);
+float get_render_scale();
+void set_scale_filter(int linear);
+int get_scale_filter();
+void cleanup_timeline();
+
+// Colour wheel shared by the cycling effects: three sines 2 radians apart
+static inline SDL_Color color_cycle(float t) {
+    SDL_Color c;
+    c.r = (Uint8)((sin(t) + 1.0f) / 2.0f * 255);
+    c.g = (Uint8)((sin(t + 2.0f) + 1.0f) / 2.0f * 255);
+    c.b = (Uint8)((sin(t + 4.0f) + 1.0f) / 2.0f * 255);
+    c.a = 255;
+    return c;
+}
+
+// --- Effects (fx_*.c) ---
+extern Effect plasma_effect;    // params: speed multiplier, wave size multiplier
+extern Effect tunnel_effect;    // params: speed along, twist around (texels/s)
+extern Effect rotozoom_effect;  // params: rotation speed (radians/s), zoom (view units per texel)
+extern Effect stars_effect;     // params: speed multiplier, trail (0 off .. 1 longest)
+extern Effect voxel_effect;     // params: flight speed (cells/s), view distance (cells), resolution (share of render size)
+extern Effect metaballs_effect; // params: share of the blob budget (1 = 384), blob radius (view units)
+extern Effect particles_effect; // params: share of the particle budget (1 = a million)
+extern Effect raster_effect;    // params: colour cycle speed, bar height (fraction of screen)
+extern Effect fire_effect;      // params: source flare chance (0..1), flame height (fraction of screen)
+extern Effect vector_effect;    // params: spin speed, object (0 cube, 1 torus, 2 object.obj), style (0 filled .. 1 wireframe)
+extern Effect logo_effect;      // params: wave amplitude (view units), wave speed (turns/s)
+extern Effect scroller_effect;  // params: scroll speed (px/s), wave amplitude (fraction of screen)
+extern Effect title_effect;     // params: vertical position (fraction of screen)
+
+// --- Show (show.c) ---
+int init_show(SDL_Renderer* renderer);
+
+#endif
@@ -0,0 +1,263 @@
+/*
+ * export.c - Frame read-back pipeline, Y4M/RGB and WAV writers.
+ */
+
+#include <SDL.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#ifdef _WIN32
+#include <io.h>
+#include <fcntl.h>
+#else
+#include <unistd.h>
+#endif
+#include "export.h"
+#include "audio.h"
+#include "cmdbuf.h"
+
+// --- Constants ---
+#define EXPORT_SLOTS 3 // Frames in flight between the main and writer threads
+#define WAV_HEADER_SIZE 44
+
+typedef struct {
+    Uint32* pixels; // ARGB8888
+    int frame;      // -1 tells the writer to stop
+} ExportSlot;
+
+// --- Globals ---
+static ExportSlot slots[EXPORT_SLOTS];
+static SDL_sem* free_slots = NULL;
+static SDL_sem* full_slots = NULL;
+static SDL_Thread* writer = NULL;
+static SDL_atomic_t write_failed;
+static int next_slot = 0; // Main thread
+
+static FILE* video = NULL;
+static FILE* wav = NULL;
+static int export_rgb = 0;
+static int out_w = 0, out_h = 0;
+static Uint8* converted = NULL;   // Writer thread
+static size_t converted_size = 0;
+static Sint16* audio_buf = NULL;  // Writer thread
+static int audio_rate = 0, audio_channels = 0;
+static Uint32 audio_bytes = 0;
+
+static int frames_queued = 0;
+static Uint64 export_start = 0;
+static Uint64 last_report = 0;
+
+
+// Binary stdout for the video; everything printed goes to stderr instead
+static FILE* open_stdout_video() {
+    fflush(stdout);
+#ifdef _WIN32
+    int fd = _dup(1);
+    if (fd < 0 || _dup2(2, 1) < 0) return NULL;
+    _setmode(fd, _O_BINARY);
+    return _fdopen(fd, "wb");
+#else
+    int fd = dup(1);
+    if (fd < 0 || dup2(2, 1) < 0) return NULL;
+    return fdopen(fd, "wb");
+#endif
+}
+
+static void put_le32(Uint8* p, Uint32 v) {
+    p[0] = v & 0xff; p[1] = (v >> 8) & 0xff; p[2] = (v >> 16) & 0xff; p[3] = v >> 24;
+}
+
+static void put_le16(Uint8* p, Uint16 v) {
+    p[0] = v & 0xff; p[1] = v >> 8;
+}
+
+// PCM header; the sizes are patched in once the length is known
+static int write_wav_header(Uint32 data_bytes) {
+    Uint8 h[WAV_HEADER_SIZE];
+    memcpy(h, "RIFF", 4);
+    put_le32(h + 4, 36 + data_bytes);
+    memcpy(h + 8, "WAVEfmt ", 8);
+    put_le32(h + 16, 16);
+    put_le16(h + 20, 1); // PCM
+    put_le16(h + 22, (Uint16)audio_channels);
+    put_le32(h + 24, (Uint32)audio_rate);
+    put_le32(h + 28, (Uint32)(audio_rate * audio_channels * 2));
+    put_le16(h + 32, (Uint16)(audio_channels * 2));
+    put_le16(h + 34, 16);
+    memcpy(h + 36, "data", 4);
+    put_le32(h + 40, data_bytes);
+    return fwrite(h, 1, sizeof(h), wav) == sizeof(h) ? 0 : 1;
+}
+
+// Samples from the start of the show to the start of `frame`, so the
+// per-frame counts add up exactly even when rate/60 is not whole
+static int audio_frames_before(int frame) {
+    return (int)((Sint64)frame * audio_rate / EXPORT_FPS);
+}
+
+static int write_frame(const ExportSlot* slot) {
+    if (export_rgb) {
+        SDL_ConvertPixels(out_w, out_h, SDL_PIXELFORMAT_ARGB8888, slot->pixels, out_w * 4,
+                          SDL_PIXELFORMAT_RGB24, converted, out_w * 3);
+    } else {
+        static const char tag[] = "FRAME\n";
+        if (fwrite(tag, 1, sizeof(tag) - 1, video) != sizeof(tag) - 1) return 1;
+        SDL_ConvertPixels(out_w, out_h, SDL_PIXELFORMAT_ARGB8888, slot->pixels, out_w * 4,
+                          SDL_PIXELFORMAT_IYUV, converted, out_w);
+    }
+    if (fwrite(converted, 1, converted_size, video) != converted_size) return 1;
+
+    if (wav) {
+        int frames = audio_frames_before(slot->frame + 1) - audio_frames_before(slot->frame);
+        render_offline_audio(audio_buf, frames);
+        size_t bytes = (size_t)frames * audio_channels * sizeof(Sint16);
+        for (int i = 0; i < frames * audio_channels; i++) {
+            audio_buf[i] = (Sint16)SDL_SwapLE16((Uint16)audio_buf[i]); // WAV is little-endian
+        }
+        if (fwrite(audio_buf, 1, bytes, wav) != bytes) return 1;
+        audio_bytes += (Uint32)bytes;
+    }
+    return 0;
+}
+
+static int writer_main(void* data) {
+    int slot = 0;
+    for (;;) {
+        SDL_SemWait(full_slots);
+        if (slots[slot].frame < 0) break;
+        if (!SDL_AtomicGet(&write_failed) && write_frame(&slots[slot]) != 0) {
+            printf("Export: write failed at frame %d\n", slots[slot].frame);
+            SDL_AtomicSet(&write_failed, 1);
+        }
+        SDL_SemPost(free_slots);
+        slot = (slot + 1) % EXPORT_SLOTS;
+    }
+    return 0;
+}
+
+int init_export(SDL_Renderer* renderer, const char* video_path, int rgb, const char* wav_path) {
+    if (SDL_GetRendererOutputSize(renderer, &out_w, &out_h) != 0) {
+        printf("Could not get the output size! SDL_Error: %s\n", SDL_GetError());
+        return 1;
+    }
+    export_rgb = rgb;
+    if (!rgb) {
+        // Chroma planes are subsampled 2x2
+#if SDL_VERSION_ATLEAST(2, 0, 8)
+        SDL_SetYUVConversionMode(SDL_YUV_CONVERSION_JPEG);
+#endif
+        converted_size = (size_t)out_w * out_h + 2 * (size_t)((out_w + 1) / 2) * ((out_h + 1) / 2);
+    } else {
+        converted_size = (size_t)out_w * out_h * 3;
+    }
+    converted = malloc(converted_size);
+
+    video = strcmp(video_path, "-") == 0 ? open_stdout_video() : fopen(video_path, "wb");
+    if (!video || !converted) {
+        printf("Could not open %s for the video export\n", video_path);
+        return 1;
+    }
+    if (!rgb) {
+        fprintf(video, "YUV4MPEG2 W%d H%d F%d:1 Ip A1:1 C420jpeg XCOLORRANGE=FULL\n", out_w, out_h, EXPORT_FPS);
+    }
+
+    if (wav_path) {
+        AudioStats a;
+        get_audio_stats(&a);
+        audio_rate = a.rate;
+        audio_channels = a.channels;
+        audio_bytes = 0;
+        audio_buf = malloc(sizeof(Sint16) * audio_channels * (audio_rate / EXPORT_FPS + 1));
+        wav = fopen(wav_path, "wb");
+        if (!audio_buf || !wav || init_offline_audio() != 0 || write_wav_header(0) != 0) {
+            printf("Could not start the audio export to %s\n", wav_path);
+            return 1;
+        }
+    }
+
+    for (int i = 0; i < EXPORT_SLOTS; i++) {
+        slots[i].pixels = malloc(sizeof(Uint32) * out_w * out_h);
+        if (!slots[i].pixels) {
+            printf("Could not allocate export buffers\n");
+            return 1;
+        }
+    }
+    free_slots = SDL_CreateSemaphore(EXPORT_SLOTS);
+    full_slots = SDL_CreateSemaphore(0);
+    SDL_AtomicSet(&write_failed, 0);
+    next_slot = 0;
+    writer = (free_slots && full_slots) ? SDL_CreateThread(writer_main, "export", NULL) : NULL;
+    if (!writer) {
+        printf("Could not start the export writer! SDL_Error: %s\n", SDL_GetError());
+        return 1;
+    }
+
+    printf("Exporting %dx%d at %d fps as %s\n", out_w, out_h, EXPORT_FPS, rgb ? "raw RGB24" : "Y4M");
+    export_start = last_report = SDL_GetPerformanceCounter();
+    frames_queued = 0;
+    return 0;
+}
+
+// Read back the finished frame; only waits when the writer is EXPORT_SLOTS behind
+int export_frame(SDL_Renderer* renderer) {
+    if (SDL_AtomicGet(&write_failed)) return 1;
+
+    ExportSlot* slot = &slots[next_slot];
+    SDL_SemWait(free_slots);
+    cmd_flush(renderer);
+    if (SDL_RenderReadPixels(renderer, NULL, SDL_PIXELFORMAT_ARGB8888, slot->pixels, out_w * 4) != 0) {
+        printf("Could not read back frame %d! SDL_Error: %s\n", frames_queued, SDL_GetError());
+        SDL_SemPost(free_slots);
+        return 1;
+    }
+    slot->frame = frames_queued++;
+    SDL_SemPost(full_slots);
+    next_slot = (next_slot + 1) % EXPORT_SLOTS;
+
+    Uint64 now = SDL_GetPerformanceCounter();
+    Uint64 freq = SDL_GetPerformanceFrequency();
+    if (now - last_report >= freq) {
+        printf("Export: %d frames, %.1f fps\n", frames_queued,
+               frames_queued * (double)freq / (double)(now - export_start));
+        last_report = now;
+    }
+    return 0;
+}
+
+// Drain the writer, finish the files and report; returns 0 on success
+int finish_export() {
+    int failed = 1;
+    if (writer) {
+        SDL_SemWait(free_slots);
+        slots[next_slot].frame = -1;
+        SDL_SemPost(full_slots);
+        SDL_WaitThread(writer, NULL);
+        writer = NULL;
+        failed = SDL_AtomicGet(&write_failed);
+
+        double seconds = (double)(SDL_GetPerformanceCounter() - export_start) / SDL_GetPerformanceFrequency();
+        printf("Exported %d frames (%.1f s of video) in %.2f s: %.1f fps\n", frames_queued,
+               (double)frames_queued / EXPORT_FPS, seconds, seconds > 0.0 ? frames_queued / seconds : 0.0);
+    }
+
+    if (wav) {
+        if (fseek(wav, 0, SEEK_SET) != 0 || write_wav_header(audio_bytes) != 0) failed = 1;
+        fclose(wav);
+    }
+    if (video && fclose(video) != 0) failed = 1;
+    wav = NULL;
+    video = NULL;
+
+    for (int i = 0; i < EXPORT_SLOTS; i++) {
+        free(slots[i].pixels);
+        slots[i].pixels = NULL;
+    }
+    if (free_slots) SDL_DestroySemaphore(free_slots);
+    if (full_slots) SDL_DestroySemaphore(full_slots);
+    free_slots = full_slots = NULL;
+    free(converted);
+    free(audio_buf);
+    converted = NULL;
+    audio_buf = NULL;
+    return failed;
+}
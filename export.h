@@ -0,0 +1,22 @@
+/*
+ * export.h - Offline render-to-video.
+ *
+ * Each finished frame is read back on the main thread into one of a few
+ * buffers and handed to a writer thread, which converts and writes it
+ * (and the frame's share of the soundtrack) while the next frame is
+ * drawn. Video goes out as YUV4MPEG2 (4:2:0, full range) or headerless
+ * RGB24, to a file or to stdout; audio goes to a 16-bit WAV file.
+ */
+
+#ifndef EXPORT_H
+#define EXPORT_H
+
+#include <SDL.h>
+
+#define EXPORT_FPS 60 // One frame per FRAME_DT
+
+int init_export(SDL_Renderer* renderer, const char* video_path, int rgb, const char* wav_path);
+int export_frame(SDL_Renderer* renderer);
+int finish_export();
+
+#endif
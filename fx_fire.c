@@ -0,0 +1,197 @@
+/*
+ * fx_fire.c - Classic demo fire: heat rising from the bottom edge.
+ *
+ * The fire is a byte grid of heat, one cell per FIRE_CELL view units.
+ * Every step fresh heat is sprinkled into two source rows below the
+ * screen, and every other cell becomes the average of the three cells
+ * below it and the one below those, minus a little cooling
+ * (kernels->fire_row). Going from the top down, each row can be updated
+ * in place: the rows it reads have not been overwritten yet. Rows above
+ * the highest flame are never touched, so a low flame border costs a few
+ * rows per step. Heat maps to colour through a palette and is added over
+ * the scene.
+ *
+ * The grid is render-side state, like the particles: prepare() steps it
+ * in fixed FRAME_DT steps up to the view's clock.
+ */
+
+#include <SDL.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "demo.h"
+#include "effect.h"
+#include "cmdbuf.h"
+#include "kernels.h"
+
+// --- Constants ---
+#define FIRE_CELL 2          // Cell size, view units
+#define SOURCE_ROWS 2        // Heat source rows, hidden below the bottom edge
+#define FLARE_W 3            // Source cells that flare up together
+#define COOL_PER_ROW 420.0f  // Cooling times flame height in rows (heat sum units)
+#define MAX_CATCH_UP 4       // Steps per frame before skipping ahead
+#define FIRE_SEED 0x2545f491u
+
+// --- Structs ---
+typedef struct {
+    float clock;     // Effect time, seconds
+    float intensity; // Chance that a source cell flares up, per step
+    float height;    // Flame height, fraction of the screen
+} FireView;
+
+typedef struct {
+    FireView view;
+    // Main thread from here on
+    Uint8* heat;     // rows x stride, with a cold column either side
+    int cols, rows;  // rows includes the source rows
+    int stride;
+    int top;         // Rows above this are cold
+    float clock;     // Time the grid has been stepped to
+    Uint32 seed;
+    Uint32 base[256];    // Heat to colour at full strength
+    Uint32 palette[256]; // Faded for the frame being drawn
+    TileLayer layer;     // GPU path
+} FireState;
+
+
+static inline Uint32 next_random(Uint32* seed) {
+    *seed = *seed * 1664525u + 1013904223u;
+    return *seed >> 8;
+}
+
+static inline Uint8* heat_row(const FireState* s, int row) {
+    return s->heat + (size_t)row * s->stride + 1;
+}
+
+static int fire_init(Effect* fx, SDL_Renderer* renderer) {
+    FireState* s = calloc(1, sizeof(FireState));
+    if (!s) return 1;
+    fx->state = s;
+    fx->view = &s->view;
+    fx->view_size = sizeof(FireView);
+    s->seed = FIRE_SEED;
+
+    // Black through red and yellow to white
+    for (int i = 0; i < 256; i++) {
+        Uint32 r = SDL_min(255, i * 3);
+        Uint32 g = SDL_max(0, SDL_min(255, (i - 80) * 3));
+        Uint32 b = SDL_max(0, SDL_min(255, (i - 170) * 3));
+        s->base[i] = 0xff000000 | r << 16 | g << 8 | b;
+    }
+    return 0;
+}
+
+static void fire_update(Effect* fx, float dt) {
+    FireView* v = &((FireState*)fx->state)->view;
+    v->clock += dt;
+    v->intensity = fx->params[0];
+    v->height = fx->params[1];
+}
+
+// Match the grid to the window's aspect; a new grid starts cold
+static int size_grid(FireState* s) {
+    int cols = view_width() / FIRE_CELL + 2;
+    if (cols == s->cols && s->heat) return 0;
+    int rows = VIEW_HEIGHT / FIRE_CELL + SOURCE_ROWS;
+    free(s->heat);
+    s->stride = cols + 2;
+    s->heat = calloc((size_t)s->stride * rows, 1);
+    if (!s->heat) {
+        printf("Could not allocate the %dx%d fire grid\n", cols, rows);
+        s->cols = s->rows = 0;
+        return 1;
+    }
+    s->cols = cols;
+    s->rows = rows;
+    s->top = rows - SOURCE_ROWS;
+    return 0;
+}
+
+static int row_is_cold(const Uint8* row, int count) {
+    for (int i = 0; i < count; i++) {
+        if (row[i]) return 0;
+    }
+    return 1;
+}
+
+static void step(FireState* s, const FireView* v) {
+    // New heat in clumps of FLARE_W cells
+    Uint32 chance = (Uint32)(SDL_max(0.0f, SDL_min(v->intensity, 1.0f)) * 16777216.0f);
+    Uint8* src = heat_row(s, s->rows - SOURCE_ROWS);
+    for (int x = 0; x < s->cols; x += FLARE_W) {
+        Uint8 h = next_random(&s->seed) < chance ? (Uint8)(0xc0 | next_random(&s->seed) >> 18) : 0;
+        memset(src + x, h, SDL_min(FLARE_W, s->cols - x));
+    }
+    memcpy(heat_row(s, s->rows - 1), src, s->cols);
+
+    // Heat climbs at most one row per step
+    int flame_rows = SDL_max(1, (int)(v->height * (s->rows - SOURCE_ROWS)));
+    Uint32 cool = (Uint32)(COOL_PER_ROW / flame_rows + 0.5f);
+    int start = SDL_max(0, s->top - 1);
+    for (int y = start; y < s->rows - SOURCE_ROWS; y++) {
+        kernels->fire_row(heat_row(s, y), heat_row(s, y + 1), heat_row(s, y + 2), s->cols, cool);
+    }
+    s->top = start;
+    while (s->top < s->rows - SOURCE_ROWS && row_is_cold(heat_row(s, s->top), s->cols)) s->top++;
+    s->clock += FRAME_DT;
+}
+
+// Catch the grid up with the snapshot and fade the palette for this frame
+static void fire_prepare(Effect* fx, const EffectFrame* frame) {
+    FireState* s = fx->state;
+    const FireView* v = frame->view;
+    if (size_grid(s) != 0) return;
+    if (v->clock - s->clock > MAX_CATCH_UP * FRAME_DT) s->clock = v->clock - MAX_CATCH_UP * FRAME_DT;
+    while (s->clock + FRAME_DT * 0.5f <= v->clock) step(s, v);
+
+    Uint32 level = (Uint32)(frame->alpha * 256);
+    for (int i = 0; i < 256; i++) {
+        Uint32 c = s->base[i];
+        s->palette[i] = 0xff000000 | (((c & 0xff00ff) * level >> 8) & 0xff00ff) | (((c & 0x00ff00) * level >> 8) & 0x00ff00);
+    }
+}
+
+// Add the fire to one tile or band; may run on any thread
+static void fire_area(void* ctx, const Tile* t) {
+    const FireState* s = ctx;
+    if (!s->heat) return;
+    Uint32 step = (Uint32)(65536.0f / (FIRE_CELL * t->scale)); // Cells per pixel, 16.16
+    int visible = s->rows - SOURCE_ROWS;
+    for (int y = t->y; y < t->y + t->h; y++) {
+        int row = SDL_min((int)((y * step + step / 2) >> 16), visible - 1);
+        if (row < s->top) continue;
+        kernels->heat_span(t->fb + (size_t)y * t->pitch + t->x, heat_row(s, row),
+                           t->x * step + step / 2, step, s->palette, t->w);
+    }
+}
+
+static void draw_band(void* ctx, const Tile* band) {
+    tile_clear(band, 0xff000000);
+    fire_area(ctx, band);
+}
+
+// Drawn at one pixel per cell, then stretched and added over the scene
+static void fire_render(Effect* fx, const EffectFrame* frame, SDL_Renderer* renderer) {
+    FireState* s = fx->state;
+    if (!s->heat) return;
+    int w = (view_width() + FIRE_CELL - 1) / FIRE_CELL;
+    if (draw_tile_layer(renderer, &s->layer, w, s->rows - SOURCE_ROWS, 1.0f / FIRE_CELL, draw_band, s) != 0) return;
+
+    SDL_Color white = { 255, 255, 255, 255 };
+    cmd_copy(s->layer.texture, NULL, NULL, white, SDL_BLENDMODE_ADD);
+}
+
+static void fire_render_tile(Effect* fx, const EffectFrame* frame, const Tile* tile) {
+    fire_area(fx->state, tile);
+}
+
+static void fire_destroy(Effect* fx) {
+    FireState* s = fx->state;
+    if (!s) return;
+    free_tile_layer(&s->layer);
+    free(s->heat);
+    free(s);
+}
+
+Effect fire_effect = { "fire", fire_init, fire_update, fire_render, fire_destroy,
+                       NULL, fire_render_tile, fire_prepare };
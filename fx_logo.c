@@ -0,0 +1,190 @@
+/*
+ * fx_logo.c - Logo picture waving from side to side, one row at a time.
+ *
+ * The logo is loaded from logo.bmp next to the font and music; without
+ * one a gradient text logo stands in. Each row strip of the logo is
+ * shifted sideways by its own sine offset. On the GPU path every strip is
+ * a copy of the same texture with the same blend mode, so the command
+ * buffer submits the whole logo as a single geometry batch however tall it
+ * is. On the CPU path each tile copies only the strips crossing it.
+ */
+
+#include <SDL.h>
+#include <SDL_ttf.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include "demo.h"
+#include "effect.h"
+#include "cmdbuf.h"
+#include "lut.h"
+
+// --- Constants ---
+#define LOGO_FILE "logo.bmp"
+#define LOGO_TEXT "SDL DEMO"   // Stand-in when there is no logo.bmp
+#define LOGO_FONT_SIZE 120
+#define LOGO_HEIGHT 160        // View units, unless that makes it too wide
+#define LOGO_MAX_WIDTH 0.8f    // Fraction of the screen width
+#define LOGO_CENTRE_Y 0.3f     // Fraction of the screen height
+#define ROW_STEP 12            // Wave phase between strips, table steps
+
+// --- Structs ---
+typedef struct {
+    Uint32 phase;    // Wave phase of the top strip, table steps
+    float amplitude; // View units
+} LogoView;
+
+typedef struct {
+    LogoView view;
+    float phase;         // Table steps, kept in float so slow speeds add up
+    SDL_Texture* texture;
+    TileImage image;     // CPU copy for the tile renderer
+    int w, h;            // Picture size, pixels
+} LogoState;
+
+// Where the logo lands this frame, view units
+typedef struct {
+    int x, y, w, h;
+} LogoRect;
+
+
+// Text stand-in, tinted from gold at the top to red at the bottom
+static SDL_Surface* text_logo() {
+    TTF_Font* big = TTF_OpenFont("font.ttf", LOGO_FONT_SIZE);
+    if (!big) {
+        printf("Failed to load logo font! TTF_Error: %s\n", TTF_GetError());
+        return NULL;
+    }
+    SDL_Color white = { 255, 255, 255, 255 };
+    SDL_Surface* text = TTF_RenderText_Blended(big, LOGO_TEXT, white);
+    TTF_CloseFont(big);
+    if (!text) {
+        printf("Unable to render logo text! TTF_Error: %s\n", TTF_GetError());
+        return NULL;
+    }
+    SDL_Surface* argb = SDL_ConvertSurfaceFormat(text, SDL_PIXELFORMAT_ARGB8888, 0);
+    SDL_FreeSurface(text);
+    if (!argb) {
+        printf("Could not convert logo text! SDL_Error: %s\n", SDL_GetError());
+        return NULL;
+    }
+
+    SDL_LockSurface(argb);
+    for (int y = 0; y < argb->h; y++) {
+        Uint32* row = (Uint32*)((Uint8*)argb->pixels + (size_t)y * argb->pitch);
+        Uint32 k = 256 * y / argb->h;
+        Uint32 r = 255, g = 220 - 180 * k / 256, b = 80 - 60 * k / 256;
+        for (int x = 0; x < argb->w; x++) {
+            Uint32 c = row[x];
+            row[x] = (c & 0xff000000) | ((c >> 16 & 0xff) * r >> 8) << 16 | ((c >> 8 & 0xff) * g >> 8) << 8 |
+                     ((c & 0xff) * b >> 8);
+        }
+    }
+    SDL_UnlockSurface(argb);
+    return argb;
+}
+
+// logo.bmp if there is one; magenta is transparent in pictures without alpha.
+// SDL_image is not linked, so PNG is not an option
+static SDL_Surface* load_logo() {
+    SDL_Surface* surface = SDL_LoadBMP(LOGO_FILE);
+    if (!surface) {
+        printf("No %s (%s), drawing a text logo instead\n", LOGO_FILE, SDL_GetError());
+        return text_logo();
+    }
+    if (!surface->format->Amask) SDL_SetColorKey(surface, SDL_TRUE, SDL_MapRGB(surface->format, 255, 0, 255));
+    return surface;
+}
+
+static int logo_init(Effect* fx, SDL_Renderer* renderer) {
+    LogoState* s = calloc(1, sizeof(LogoState));
+    if (!s) return 1;
+    fx->state = s;
+    fx->view = &s->view;
+    fx->view_size = sizeof(LogoView);
+
+    SDL_Surface* surface = load_logo();
+    if (!surface) return 1;
+    s->texture = SDL_CreateTextureFromSurface(renderer, surface);
+    if (!s->texture) {
+        printf("Unable to create logo texture! SDL_Error: %s\n", SDL_GetError());
+        SDL_FreeSurface(surface);
+        return 1;
+    }
+    s->w = surface->w;
+    s->h = surface->h;
+    int failed = tiles_enabled() && tile_image_from_surface(&s->image, surface) != 0;
+    SDL_FreeSurface(surface);
+    return failed;
+}
+
+static void logo_update(Effect* fx, float dt) {
+    LogoState* s = fx->state;
+    s->phase += fx->params[1] * SINE_STEPS * dt;
+    if (s->phase >= SINE_STEPS) s->phase -= SINE_STEPS;
+    s->view.phase = (Uint32)s->phase;
+    s->view.amplitude = fx->params[0];
+}
+
+// LOGO_HEIGHT tall and centred, shrunk to fit narrow windows
+static LogoRect place_logo(const LogoState* s) {
+    LogoRect r;
+    float k = SDL_min((float)LOGO_HEIGHT / s->h, LOGO_MAX_WIDTH * view_width() / s->w);
+    r.w = SDL_max((int)(s->w * k), 1);
+    r.h = SDL_max((int)(s->h * k), 1);
+    r.x = (view_width() - r.w) / 2;
+    r.y = (int)(VIEW_HEIGHT * LOGO_CENTRE_Y) - r.h / 2;
+    return r;
+}
+
+// Strip i is one view unit of the logo's height, cut from the picture rows
+// that land there and shifted by the wave
+static void strip_rects(const LogoState* s, const LogoView* v, const LogoRect* r, int i,
+                        SDL_Rect* src, SDL_Rect* dst) {
+    int y0 = i * s->h / r->h, y1 = (i + 1) * s->h / r->h;
+    src->x = 0;
+    src->y = SDL_min(y0, s->h - 1);
+    src->w = s->w;
+    src->h = SDL_max(y1 - y0, 1);
+    dst->x = r->x + (int)(v->amplitude * lut_sin(v->phase + i * ROW_STEP) / SINE_ONE);
+    dst->y = r->y + i;
+    dst->w = r->w;
+    dst->h = 1;
+}
+
+// Every strip shares the texture and blend mode: one batch
+static void logo_render(Effect* fx, const EffectFrame* frame, SDL_Renderer* renderer) {
+    const LogoState* s = fx->state; // Texture and size, fixed after init
+    const LogoView* v = frame->view;
+    LogoRect r = place_logo(s);
+    SDL_Color mod = { 255, 255, 255, (Uint8)(255 * frame->alpha) };
+    for (int i = 0; i < r.h; i++) {
+        SDL_Rect src, dst;
+        strip_rects(s, v, &r, i, &src, &dst);
+        cmd_copy(s->texture, &src, &dst, mod, SDL_BLENDMODE_BLEND);
+    }
+}
+
+// Only the strips that cross the tile
+static void logo_render_tile(Effect* fx, const EffectFrame* frame, const Tile* tile) {
+    const LogoState* s = fx->state;
+    const LogoView* v = frame->view;
+    LogoRect r = place_logo(s);
+    SDL_Color mod = { 255, 255, 255, (Uint8)(255 * frame->alpha) };
+    int first = SDL_max(0, (int)(tile->y / tile->scale) - r.y - 1);
+    int last = SDL_min(r.h, (int)((tile->y + tile->h) / tile->scale) - r.y + 2);
+    for (int i = first; i < last; i++) {
+        SDL_Rect src, dst;
+        strip_rects(s, v, &r, i, &src, &dst);
+        tile_blit_part(tile, &s->image, &src, &dst, mod);
+    }
+}
+
+static void logo_destroy(Effect* fx) {
+    LogoState* s = fx->state;
+    if (!s) return;
+    if (s->texture) SDL_DestroyTexture(s->texture);
+    free_tile_image(&s->image);
+    free(s);
+}
+
+Effect logo_effect = { "logo", logo_init, logo_update, logo_render, logo_destroy, NULL, logo_render_tile };
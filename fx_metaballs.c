@@ -0,0 +1,200 @@
+/*
+ * fx_metaballs.c - Hundreds of blobs merging into one glowing field.
+ *
+ * Each blob adds max(0, 1 - d^2 / r^2)^2 to a per-pixel field, which is
+ * coloured through a palette with a bright rim where the field crosses 1
+ * and added over the scene (kernels->metaball_span). The falloff reaches
+ * exactly zero at the blob's radius, so a pixel only needs the blobs whose
+ * bounding box covers its tile. Every tile collects those first and every
+ * row drops the ones it misses, so the cost per pixel follows how many
+ * blobs overlap there, not how many there are.
+ *
+ * The blobs wander on Lissajous paths worked out on the simulation
+ * thread; the view carries their positions and the faded palette.
+ */
+
+#include <SDL.h>
+#include <stdlib.h>
+#include "demo.h"
+#include "effect.h"
+#include "cmdbuf.h"
+#include "governor.h"
+#include "kernels.h"
+
+// --- Constants ---
+#define MAX_BLOBS 384
+#define PALETTE_SIZE 256
+#define RIM_INDEX 128       // Field 1, see kernels.h
+#define PALETTE_SPEED 0.4f  // Colour cycle, radians/s
+#define BLOB_SEED 0x6d2b79f5u
+
+// --- Structs ---
+typedef struct {
+    float x[MAX_BLOBS], y[MAX_BLOBS]; // Centres, view units
+    float r[MAX_BLOBS];               // Radii, view units
+    int count;
+    int detail;
+    Uint32 palette[PALETTE_SIZE];     // Coloured and faded for this step
+} MetaballsView;
+
+// Fixed per blob: path frequencies (radians/s), phases and size
+typedef struct {
+    float fx, fy;
+    float px, py;
+    float size; // Share of the radius parameter, 0.6..1
+} BlobPath;
+
+typedef struct {
+    MetaballsView view;
+    float time;
+    BlobPath paths[MAX_BLOBS];
+    TileLayer layer; // GPU path, main thread
+} MetaballsState;
+
+// Blobs near one tile, in pixels
+typedef struct {
+    float x[MAX_BLOBS], y[MAX_BLOBS], inv_r2[MAX_BLOBS];
+    float top[MAX_BLOBS], bottom[MAX_BLOBS];
+    int count;
+} BlobList;
+
+
+static inline float random_unit(Uint32* seed) {
+    *seed = *seed * 1664525u + 1013904223u;
+    return (float)(*seed >> 8) * (1.0f / 16777216.0f);
+}
+
+static int metaballs_init(Effect* fx, SDL_Renderer* renderer) {
+    MetaballsState* s = calloc(1, sizeof(MetaballsState));
+    if (!s) return 1;
+    fx->state = s;
+    fx->view = &s->view;
+    fx->view_size = sizeof(MetaballsView);
+
+    Uint32 seed = BLOB_SEED;
+    for (int i = 0; i < MAX_BLOBS; i++) {
+        BlobPath* p = &s->paths[i];
+        p->fx = 0.15f + 0.5f * random_unit(&seed);
+        p->fy = 0.15f + 0.5f * random_unit(&seed);
+        p->px = 6.2831853f * random_unit(&seed);
+        p->py = 6.2831853f * random_unit(&seed);
+        p->size = 0.6f + 0.4f * random_unit(&seed);
+    }
+    return 0;
+}
+
+// Dim glow outside the blobs, a bright rim at field 1, white-hot cores
+static Uint32 palette_entry(SDL_Color c, int i, Uint32 level) {
+    float k;
+    if (i < RIM_INDEX - 24) k = 0.3f * i / (RIM_INDEX - 24);
+    else if (i < RIM_INDEX) k = 0.3f + 0.7f * (i - (RIM_INDEX - 24)) / 24.0f;
+    else k = 1.0f;
+    float white = i < RIM_INDEX ? 0.0f : 0.6f * (i - RIM_INDEX) / (PALETTE_SIZE - RIM_INDEX);
+    Uint32 r = (Uint32)((c.r + (255 - c.r) * white) * k) * level >> 8;
+    Uint32 g = (Uint32)((c.g + (255 - c.g) * white) * k) * level >> 8;
+    Uint32 b = (Uint32)((c.b + (255 - c.b) * white) * k) * level >> 8;
+    return 0xff000000 | r << 16 | g << 8 | b;
+}
+
+static void metaballs_update(Effect* fx, float dt) {
+    MetaballsState* s = fx->state;
+    MetaballsView* v = &s->view;
+    s->time += dt;
+
+    const Quality* q = current_quality();
+    v->count = SDL_max(0, SDL_min((int)(MAX_BLOBS * fx->params[0] * q->particle_fraction), MAX_BLOBS));
+    v->detail = q->detail;
+    float w = (float)view_width(), t = s->time;
+    for (int i = 0; i < v->count; i++) {
+        const BlobPath* p = &s->paths[i];
+        v->x[i] = w * (0.5f + 0.42f * sinf(t * p->fx + p->px));
+        v->y[i] = VIEW_HEIGHT * (0.5f + 0.42f * sinf(t * p->fy + p->py));
+        v->r[i] = fx->params[1] * p->size;
+    }
+
+    SDL_Color c = color_cycle(t * PALETTE_SPEED);
+    Uint32 level = (Uint32)(fx->alpha * 256);
+    for (int i = 0; i < PALETTE_SIZE; i++) v->palette[i] = palette_entry(c, i, level);
+}
+
+// Blobs whose bounding box reaches the area, converted to pixels
+static void collect_blobs(const MetaballsView* v, float scale, int x0, int y0, int x1, int y1, BlobList* out) {
+    out->count = 0;
+    for (int i = 0; i < v->count; i++) {
+        float x = v->x[i] * scale, y = v->y[i] * scale, r = v->r[i] * scale;
+        if (r <= 0.0f || x + r < x0 || x - r > x1 || y + r < y0 || y - r > y1) continue;
+        int n = out->count++;
+        out->x[n] = x;
+        out->y[n] = y;
+        out->inv_r2[n] = 1.0f / (r * r);
+        out->top[n] = y - r;
+        out->bottom[n] = y + r;
+    }
+}
+
+// One tile-sized block: gather its blobs, then each row's
+static void draw_block(const MetaballsView* v, const Tile* t, int x0, int y0, int w, int h) {
+    BlobList near, row;
+    collect_blobs(v, t->scale, x0, y0, x0 + w, y0 + h, &near);
+    if (near.count == 0) return;
+
+    for (int y = y0; y < y0 + h; y++) {
+        float cy = y + 0.5f;
+        row.count = 0;
+        for (int i = 0; i < near.count; i++) {
+            if (cy <= near.top[i] || cy >= near.bottom[i]) continue;
+            row.x[row.count] = near.x[i];
+            row.y[row.count] = near.y[i];
+            row.inv_r2[row.count] = near.inv_r2[i];
+            row.count++;
+        }
+        if (row.count == 0) continue;
+        kernels->metaball_span(t->fb + (size_t)y * t->pitch + x0, x0 + 0.5f, cy, row.x, row.y,
+                               row.inv_r2, row.count, v->palette, w);
+    }
+}
+
+// Any tile or band; bands are cut into TILE_SIZE blocks so the culling
+// stays tight. May run on any thread
+static void metaballs_area(void* ctx, const Tile* t) {
+    for (int y = t->y; y < t->y + t->h; y += TILE_SIZE) {
+        for (int x = t->x; x < t->x + t->w; x += TILE_SIZE) {
+            draw_block(ctx, t, x, y, SDL_min(TILE_SIZE, t->x + t->w - x), SDL_min(TILE_SIZE, t->y + t->h - y));
+        }
+    }
+}
+
+static void draw_band(void* ctx, const Tile* band) {
+    tile_clear(band, 0xff000000);
+    metaballs_area(ctx, band);
+}
+
+// Drawn into a streaming texture, at half resolution below full detail,
+// then added over the scene
+static void metaballs_render(Effect* fx, const EffectFrame* frame, SDL_Renderer* renderer) {
+    MetaballsState* s = fx->state;
+    const MetaballsView* v = frame->view;
+    int shift = v->detail >= 2 ? 0 : 1;
+    float scale = get_render_scale();
+    int w = SDL_max((int)(screen_width() * scale) >> shift, 1);
+    int h = SDL_max((int)(screen_height() * scale) >> shift, 1);
+    float px = view_to_pixels() * scale / (1 << shift);
+    if (draw_tile_layer(renderer, &s->layer, w, h, px, draw_band, (void*)v) != 0) return;
+
+    SDL_Color white = { 255, 255, 255, 255 };
+    cmd_copy(s->layer.texture, NULL, NULL, white, SDL_BLENDMODE_ADD);
+}
+
+static void metaballs_render_tile(Effect* fx, const EffectFrame* frame, const Tile* tile) {
+    metaballs_area((void*)frame->view, tile);
+}
+
+static void metaballs_destroy(Effect* fx) {
+    MetaballsState* s = fx->state;
+    if (!s) return;
+    free_tile_layer(&s->layer);
+    free(s);
+}
+
+Effect metaballs_effect = { "metaballs", metaballs_init, metaballs_update, metaballs_render, metaballs_destroy,
+                            NULL, metaballs_render_tile };
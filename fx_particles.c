@@ -0,0 +1,193 @@
+/*
+ * fx_particles.c - Fountains and firework bursts from the particle engine.
+ *
+ * The particles are render-side state. The view only carries the effect's
+ * clock and particle budget, and prepare() steps the pool in fixed
+ * FRAME_DT steps until it has caught up with that clock. A million
+ * particles are far too many to copy into every snapshot, and stepping
+ * them on the main thread lets integration and binning use the job pool.
+ * Spawning draws from its own random sequence, so the particles replay
+ * exactly in deterministic mode. Every time the effect comes back on
+ * screen its clock starts over and the pool is emptied, so nothing left
+ * in flight from the last appearance carries on.
+ */
+
+#include <SDL.h>
+#include <stdlib.h>
+#include "demo.h"
+#include "effect.h"
+#include "cmdbuf.h"
+#include "governor.h"
+#include "kernels.h"
+#include "lut.h"
+#include "particles.h"
+
+// --- Constants ---
+#define PARTICLE_CAPACITY (1 << 20)
+#define MAX_CATCH_UP 4        // Steps per frame before skipping ahead
+#define GRAVITY 260.0f        // View units per second squared
+#define DRAG 0.998f           // Velocity kept per step
+#define FADE_TIME 0.6f        // Fade-out at the end of a particle's life, seconds
+#define LIFE_AVG 2.0f         // Average particle life, sets the spawn rates
+#define BURST_INTERVAL 0.5f   // Seconds between firework bursts
+#define BURST_SHARE 0.4f      // Share of the budget spent on bursts; fountains get the rest
+#define PARTICLE_SEED 0x9e3779b9u
+
+// --- Structs ---
+typedef struct {
+    float clock; // Effect time since it came on screen, seconds
+    Uint32 run;  // Counts appearances on screen
+    int budget;  // Live particles to aim for
+    int detail;
+} ParticlesView;
+
+typedef struct {
+    ParticlesView view;
+    // Main thread from here on
+    ParticlePool pool;
+    float clock; // Time the pool has been stepped to
+    Uint32 run;  // Appearance the pool belongs to
+    float next_burst;
+    Uint32 seed;
+    TileLayer layer; // GPU path
+    int grid_w, grid_h; // Layer size the pool was last binned for
+    float grid_scale;
+} ParticlesState;
+
+
+static inline float random_range(Uint32* seed, float lo, float hi) {
+    *seed = *seed * 1664525u + 1013904223u;
+    return lo + (hi - lo) * (float)(*seed >> 8) * (1.0f / 16777216.0f);
+}
+
+static int particles_init(Effect* fx, SDL_Renderer* renderer) {
+    ParticlesState* s = calloc(1, sizeof(ParticlesState));
+    if (!s) return 1;
+    fx->state = s;
+    fx->view = &s->view;
+    fx->view_size = sizeof(ParticlesView);
+    s->seed = PARTICLE_SEED;
+    return init_particle_pool(&s->pool, PARTICLE_CAPACITY);
+}
+
+static void particles_update(Effect* fx, float dt) {
+    ParticlesView* v = &((ParticlesState*)fx->state)->view;
+    if (fx->entered) {
+        v->clock = 0.0f;
+        v->run++;
+    }
+    v->clock += dt;
+    v->budget = (int)(PARTICLE_CAPACITY * fx->params[0] * current_quality()->particle_fraction);
+    v->budget = SDL_min(v->budget, PARTICLE_CAPACITY);
+    v->detail = current_quality()->detail;
+}
+
+// Two fountains of golden sparks from the bottom edge
+static void spawn_fountains(ParticlesState* s, int n) {
+    ParticlePool* p = &s->pool;
+    float w = (float)view_width();
+    for (int i = spawn_particles(p, n); i < p->count; i++) {
+        p->x[i] = (i & 1 ? 0.75f : 0.25f) * w + random_range(&s->seed, -6.0f, 6.0f);
+        p->y[i] = VIEW_HEIGHT + 2.0f;
+        // Up to 12 degrees off vertical, so the spray forms a dome
+        Uint32 angle = (Uint32)random_range(&s->seed, SINE_STEPS - 34.0f, SINE_STEPS + 34.0f);
+        float speed = random_range(&s->seed, 300.0f, 430.0f) / SINE_ONE;
+        p->vx[i] = lut_sin(angle) * speed;
+        p->vy[i] = -lut_cos(angle) * speed;
+        p->life[i] = random_range(&s->seed, 0.6f, 1.4f) * LIFE_AVG;
+        Uint32 g = (Uint32)random_range(&s->seed, 110.0f, 220.0f);
+        p->color[i] = 0xff000000 | 0xff0000 | g << 8 | 40;
+    }
+}
+
+// One spherical burst of a single colour somewhere in the upper half
+static void spawn_burst(ParticlesState* s, int n) {
+    ParticlePool* p = &s->pool;
+    float cx = random_range(&s->seed, 0.15f, 0.85f) * view_width();
+    float cy = random_range(&s->seed, 80.0f, 300.0f);
+    SDL_Color c = color_cycle(random_range(&s->seed, 0.0f, 6.2831853f));
+    for (int i = spawn_particles(p, n); i < p->count; i++) {
+        Uint32 angle = (Uint32)random_range(&s->seed, 0.0f, SINE_STEPS);
+        float speed = random_range(&s->seed, 5.0f, 230.0f) / SINE_ONE;
+        p->x[i] = cx;
+        p->y[i] = cy;
+        p->vx[i] = lut_cos(angle) * speed;
+        p->vy[i] = lut_sin(angle) * speed;
+        p->life[i] = random_range(&s->seed, 0.6f, 1.2f) * LIFE_AVG;
+        p->color[i] = 0xff000000 | (Uint32)c.r << 16 | (Uint32)c.g << 8 | c.b;
+    }
+}
+
+static void step(ParticlesState* s, int budget) {
+    int room = SDL_max(0, budget - s->pool.count);
+    int fountain = (int)(budget * (1.0f - BURST_SHARE) * FRAME_DT / LIFE_AVG);
+    spawn_fountains(s, SDL_min(fountain, room));
+
+    if (s->clock >= s->next_burst) {
+        s->next_burst = s->clock + BURST_INTERVAL;
+        room = SDL_max(0, budget - s->pool.count);
+        spawn_burst(s, SDL_min((int)(budget * BURST_SHARE * BURST_INTERVAL / LIFE_AVG), room));
+    }
+    step_particles(&s->pool, FRAME_DT, GRAVITY, DRAG);
+    s->clock += FRAME_DT;
+}
+
+// Catch the pool up with the snapshot, then sort it for the grid about to be drawn
+static void particles_prepare(Effect* fx, const EffectFrame* frame) {
+    ParticlesState* s = fx->state;
+    const ParticlesView* v = frame->view;
+    // A new appearance, or a clock that went backwards: start from an empty sky
+    if (v->run != s->run || v->clock < s->clock - FRAME_DT) {
+        s->pool.count = 0;
+        s->clock = 0.0f;
+        s->next_burst = 0.0f;
+        s->run = v->run;
+    }
+    if (v->clock - s->clock > MAX_CATCH_UP * FRAME_DT) s->clock = v->clock - MAX_CATCH_UP * FRAME_DT;
+    while (s->clock + FRAME_DT * 0.5f <= v->clock) step(s, v->budget);
+
+    Uint32 level = (Uint32)(frame->alpha * 256);
+    float scale = get_render_scale();
+    int w = (int)(screen_width() * scale), h = (int)(screen_height() * scale);
+    float px = view_to_pixels() * scale;
+    if (tiles_enabled()) {
+        bin_particles(&s->pool, w, h, px, TILE_SIZE, TILE_SIZE, level, FADE_TIME);
+        return;
+    }
+    // The GPU path splats into its own layer, in full-width bands
+    int shift = v->detail >= 2 ? 0 : 1;
+    s->grid_w = SDL_max(w >> shift, 1);
+    s->grid_h = SDL_max(h >> shift, 1);
+    s->grid_scale = px / (1 << shift);
+    bin_particles(&s->pool, s->grid_w, s->grid_h, s->grid_scale, s->grid_w, TILE_SIZE, level, FADE_TIME);
+}
+
+static void draw_band(void* ctx, const Tile* band) {
+    tile_clear(band, 0xff000000);
+    splat_particles(ctx, band);
+}
+
+// Splatted on the CPU, then added over the scene
+static void particles_render(Effect* fx, const EffectFrame* frame, SDL_Renderer* renderer) {
+    ParticlesState* s = fx->state;
+    if (!s->pool.cell_start) return;
+    if (draw_tile_layer(renderer, &s->layer, s->grid_w, s->grid_h, s->grid_scale, draw_band, &s->pool) != 0) return;
+
+    SDL_Color white = { 255, 255, 255, 255 };
+    cmd_copy(s->layer.texture, NULL, NULL, white, SDL_BLENDMODE_ADD);
+}
+
+static void particles_render_tile(Effect* fx, const EffectFrame* frame, const Tile* tile) {
+    splat_particles(&((ParticlesState*)fx->state)->pool, tile);
+}
+
+static void particles_destroy(Effect* fx) {
+    ParticlesState* s = fx->state;
+    if (!s) return;
+    free_tile_layer(&s->layer);
+    free_particle_pool(&s->pool);
+    free(s);
+}
+
+Effect particles_effect = { "particles", particles_init, particles_update, particles_render, particles_destroy,
+                            NULL, particles_render_tile, particles_prepare };
@@ -0,0 +1,153 @@
+/*
+ * fx_plasma.c - Full-screen plasma from summed sine waves.
+ *
+ * Every pixel is a palette index: the sum of two waves along x, one along
+ * y and one along the diagonal, read from the shared sine table (lut.h).
+ * Each wave depends on a single coordinate, so a tile only needs one short
+ * table per wave, and the per-pixel work left is two byte adds and a
+ * palette lookup (kernels->plasma_span). The colours move by rotating the
+ * palette, which also carries the fade.
+ *
+ * On the GPU path the plasma is computed on the job pool into a streaming
+ * texture (draw_tile_layer); on the CPU path straight into the tiles.
+ */
+
+#include <SDL.h>
+#include <stdlib.h>
+#include "demo.h"
+#include "effect.h"
+#include "cmdbuf.h"
+#include "governor.h"
+#include "kernels.h"
+#include "lut.h"
+
+// --- Constants ---
+#define PLASMA_WAVES 4
+#define PLASMA_CHUNK 256   // Columns per wave table
+#define PALETTE_SIZE 256
+#define PALETTE_SPEED 40.0f // Palette entries per second
+#define PALETTE_LEVEL 150  // Brightness out of 256, keeps the stars readable
+
+// Waves along x, x, y and the diagonal: frequencies in table steps per
+// view unit and phase speeds in table steps per second
+static const float wave_freq[PLASMA_WAVES] = { 5.3f, 3.1f, 4.1f, 2.7f };
+static const float wave_speed[PLASMA_WAVES] = { 90.0f, -70.0f, 55.0f, 120.0f };
+
+// --- Structs ---
+typedef struct {
+    Uint32 phase[PLASMA_WAVES]; // 16.16 fixed-point table positions
+    float zoom;                 // Wave size multiplier
+    int detail;
+    Uint32 palette[PALETTE_SIZE]; // Rotated and faded for this step
+} PlasmaView;
+
+typedef struct {
+    PlasmaView view;
+    Uint32 palette_pos; // 16.16 rotation
+    Uint32 base_palette[PALETTE_SIZE];
+    TileLayer layer;    // GPU path, main thread
+} PlasmaState;
+
+// --- Globals ---
+static Uint8 wave[SINE_STEPS]; // 0..63, so four waves still fit in a byte
+
+
+static int plasma_init(Effect* fx, SDL_Renderer* renderer) {
+    PlasmaState* s = calloc(1, sizeof(PlasmaState));
+    if (!s) return 1;
+    fx->state = s;
+    fx->view = &s->view;
+    fx->view_size = sizeof(PlasmaView);
+
+    for (int i = 0; i < SINE_STEPS; i++) {
+        wave[i] = (Uint8)(32 + lut_sin(i) * 31 / SINE_ONE);
+    }
+    for (int i = 0; i < PALETTE_SIZE; i++) {
+        SDL_Color c = color_cycle(i * 2.0f * (float)M_PI / PALETTE_SIZE);
+        s->base_palette[i] = 0xff000000 | (Uint32)(c.r * PALETTE_LEVEL >> 8) << 16 |
+                             (Uint32)(c.g * PALETTE_LEVEL >> 8) << 8 | (Uint32)(c.b * PALETTE_LEVEL >> 8);
+    }
+    return 0;
+}
+
+static void plasma_update(Effect* fx, float dt) {
+    PlasmaState* s = fx->state;
+    PlasmaView* v = &s->view;
+    float speed = fx->params[0];
+    for (int k = 0; k < PLASMA_WAVES; k++) {
+        v->phase[k] += (Uint32)(Sint32)(wave_speed[k] * speed * dt * 65536.0f);
+    }
+    v->zoom = fx->params[1];
+    v->detail = current_quality()->detail;
+
+    // Rotate the palette and fade it towards black
+    s->palette_pos += (Uint32)(PALETTE_SPEED * speed * dt * 65536.0f);
+    Uint32 shift = s->palette_pos >> 16;
+    Uint32 a = (Uint32)(fx->alpha * 256);
+    for (int i = 0; i < PALETTE_SIZE; i++) {
+        Uint32 c = s->base_palette[(i + shift) & (PALETTE_SIZE - 1)];
+        v->palette[i] = 0xff000000 | (((c & 0xff00ff) * a >> 8) & 0xff00ff) | (((c & 0x00ff00) * a >> 8) & 0x00ff00);
+    }
+}
+
+static inline Uint8 wave_at(Uint32 pos) {
+    return wave[(pos >> 16) & (SINE_STEPS - 1)];
+}
+
+// Fill one tile or band; may run on any thread
+static void plasma_area(void* ctx, const Tile* t) {
+    const PlasmaView* v = ctx;
+    Uint32 step[PLASMA_WAVES]; // 16.16 table steps per pixel
+    for (int k = 0; k < PLASMA_WAVES; k++) {
+        step[k] = (Uint32)(wave_freq[k] / (v->zoom * t->scale) * 65536.0f);
+    }
+
+    Uint8 rows[TILE_SIZE];
+    Uint8 col[PLASMA_CHUNK];
+    Uint8 diag[PLASMA_CHUNK + TILE_SIZE];
+    for (int y = 0; y < t->h; y++) rows[y] = wave_at(step[2] * (Uint32)(t->y + y) + v->phase[2]);
+
+    for (int x0 = 0; x0 < t->w; x0 += PLASMA_CHUNK) {
+        int w = SDL_min(PLASMA_CHUNK, t->w - x0);
+        Uint32 x = (Uint32)(t->x + x0);
+        for (int i = 0; i < w; i++) {
+            col[i] = wave_at(step[0] * (x + i) + v->phase[0]) + wave_at(step[1] * (x + i) + v->phase[1]);
+        }
+        // Pixel (x + i, t->y + y) reads diag[i + y]
+        for (int i = 0; i < w + t->h - 1; i++) {
+            diag[i] = wave_at(step[3] * (x + (Uint32)t->y + i) + v->phase[3]);
+        }
+        for (int y = 0; y < t->h; y++) {
+            Uint32* dst = t->fb + (size_t)(t->y + y) * t->pitch + x;
+            kernels->plasma_span(dst, col, diag + y, rows[y], v->palette, w);
+        }
+    }
+}
+
+// Computed into a streaming texture, at half resolution below full detail
+static void plasma_render(Effect* fx, const EffectFrame* frame, SDL_Renderer* renderer) {
+    PlasmaState* s = fx->state;
+    const PlasmaView* v = frame->view;
+    int shift = v->detail >= 2 ? 0 : 1;
+    float scale = get_render_scale();
+    int w = (int)(screen_width() * scale) >> shift;
+    int h = (int)(screen_height() * scale) >> shift;
+    float px = view_to_pixels() * scale / (1 << shift);
+    if (draw_tile_layer(renderer, &s->layer, w, h, px, plasma_area, (void*)v) != 0) return;
+
+    SDL_Color white = { 255, 255, 255, 255 };
+    cmd_copy(s->layer.texture, NULL, NULL, white, SDL_BLENDMODE_NONE); // The fade is in the palette
+}
+
+static void plasma_render_tile(Effect* fx, const EffectFrame* frame, const Tile* tile) {
+    plasma_area((void*)frame->view, tile);
+}
+
+static void plasma_destroy(Effect* fx) {
+    PlasmaState* s = fx->state;
+    if (!s) return;
+    free_tile_layer(&s->layer);
+    free(s);
+}
+
+Effect plasma_effect = { "plasma", plasma_init, plasma_update, plasma_render, plasma_destroy, NULL, plasma_render_tile };
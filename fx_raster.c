@@ -0,0 +1,69 @@
+/*
+ * fx_raster.c - Moving, colour-cycling raster bar.
+ */
+
+#include <SDL.h>
+#include <stdlib.h>
+#include <math.h>
+#include "demo.h"
+#include "effect.h"
+#include "cmdbuf.h"
+
+typedef struct {
+    float time_counter;
+} RasterState;
+
+
+static int raster_init(Effect* fx, SDL_Renderer* renderer) {
+    fx->state = calloc(1, sizeof(RasterState));
+    fx->view = fx->state;
+    fx->view_size = sizeof(RasterState);
+    return fx->state ? 0 : 1;
+}
+
+static void raster_update(Effect* fx, float dt) {
+    RasterState* s = fx->state;
+    s->time_counter += 3.0f * dt; // 0.05 per 60 Hz frame
+}
+
+// Position and colour of the bar for this frame
+static void raster_bar(const EffectFrame* frame, SDL_Rect* out, SDL_Color* out_color) {
+    const RasterState* s = frame->view;
+    float t = s->time_counter;
+    float cycle = frame->params[0];
+
+    // Calculate color based on time
+    SDL_Color color = color_cycle(t * cycle);
+    color.a = (Uint8)(100 * frame->alpha); // 100 for alpha
+
+    // Calculate position based on time
+    SDL_Rect bar;
+    bar.x = 0;
+    bar.w = view_width();
+    bar.h = (int)(VIEW_HEIGHT * frame->params[1]);
+    bar.y = (int)((sin(t) + 1.0f) / 2.0f * (VIEW_HEIGHT - bar.h));
+
+    *out = bar;
+    *out_color = color;
+}
+
+// Render the moving, color-cycling raster bar
+static void raster_render(Effect* fx, const EffectFrame* frame, SDL_Renderer* renderer) {
+    SDL_Rect bar;
+    SDL_Color color;
+    raster_bar(frame, &bar, &color);
+    cmd_fill_rect(&bar, color, SDL_BLENDMODE_BLEND); // Blended for transparency
+}
+
+static void raster_render_tile(Effect* fx, const EffectFrame* frame, const Tile* tile) {
+    SDL_Rect bar;
+    SDL_Color color;
+    raster_bar(frame, &bar, &color);
+    tile_fill_rect(tile, &bar, color);
+}
+
+static void raster_destroy(Effect* fx) {
+    free(fx->state);
+}
+
+Effect raster_effect = { "raster", raster_init, raster_update, raster_render, raster_destroy, NULL, raster_render_tile };
@@ -0,0 +1,179 @@
+/*
+ * fx_rotozoom.c - Rotating, zooming tiled texture across the whole screen.
+ *
+ * Every output pixel is a texel of a 256x256 tile that repeats forever.
+ * Rotation and zoom are the same for the whole screen, so along a
+ * scanline the texture coordinate only moves by a constant step: each row
+ * works out its starting coordinate once and then adds that step per
+ * pixel in 16.16 fixed point (kernels->rotozoom_span). Rows run in
+ * parallel, as tiles on the CPU path and as bands of a streaming texture
+ * on the GPU path.
+ */
+
+#include <SDL.h>
+#include <SDL_ttf.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <math.h>
+#include "demo.h"
+#include "effect.h"
+#include "cmdbuf.h"
+#include "governor.h"
+#include "kernels.h"
+
+// --- Constants ---
+#define TEX_SIZE 256       // Texture is TEX_SIZE x TEX_SIZE; coordinates wrap
+#define CHECKER 32         // Background square size, texels
+#define LOGO_FONT_SIZE 96
+#define ZOOM_RATE 0.7f     // Zoom pulses, radians/s
+#define PAN_U 40.0f        // Texture drift, texels/s
+#define PAN_V 25.0f
+
+// --- Structs ---
+typedef struct {
+    float angle; // Radians
+    float zoom;  // View units per texel
+    float u, v;  // Texel at the screen centre
+    int detail;
+} RotozoomView;
+
+typedef struct {
+    RotozoomView view;
+    float time;
+    TileLayer layer; // GPU path
+    Uint32 texture[TEX_SIZE * TEX_SIZE];
+} RotozoomState;
+
+// Everything a tile needs: the texel at pixel (0, 0) and the steps per
+// pixel along x (du, dv) and along y (-dv, du)
+typedef struct {
+    const Uint32* texture;
+    Uint32 u, v;
+    Uint32 du, dv;
+    Uint32 level;
+} RotozoomFrame;
+
+
+// Checkerboard with the word stamped in the middle, so the tiling shows
+static int build_texture(RotozoomState* s) {
+    for (int y = 0; y < TEX_SIZE; y++) {
+        for (int x = 0; x < TEX_SIZE; x++) {
+            int dark = (x / CHECKER + y / CHECKER) & 1;
+            Uint32 ramp = (Uint32)abs(((x + y) & 0xff) - 0x80); // Seamless across the wrap
+            Uint32 r = dark ? 0x30 : 0x70, g = ramp / 2 + 0x10, b = dark ? 0x70 : 0xc0;
+            s->texture[y * TEX_SIZE + x] = 0xff000000 | r << 16 | g << 8 | b;
+        }
+    }
+
+    TTF_Font* big = TTF_OpenFont("font.ttf", LOGO_FONT_SIZE);
+    if (!big) {
+        printf("Failed to load rotozoom font! TTF_Error: %s\n", TTF_GetError());
+        return 1;
+    }
+    SDL_Color white = { 255, 255, 255, 255 };
+    SDL_Surface* surface = TTF_RenderText_Blended(big, "SDL", white);
+    TTF_CloseFont(big);
+    if (!surface) {
+        printf("Unable to render rotozoom text! TTF_Error: %s\n", TTF_GetError());
+        return 1;
+    }
+    TileImage image = { NULL, 0, 0 };
+    int failed = tile_image_from_surface(&image, surface);
+    SDL_FreeSurface(surface);
+    if (failed) return 1;
+
+    // The texture is a tiny framebuffer at one pixel per unit; tile_blit
+    // wants tiles no bigger than TILE_SIZE
+    SDL_Rect shadow = { (TEX_SIZE - image.w) / 2 + 4, (TEX_SIZE - image.h) / 2 + 4, image.w, image.h };
+    SDL_Rect face = { shadow.x - 4, shadow.y - 4, image.w, image.h };
+    SDL_Color black = { 0, 0, 0, 160 };
+    SDL_Color gold = { 255, 200, 60, 255 };
+    for (int y = 0; y < TEX_SIZE; y += TILE_SIZE) {
+        for (int x = 0; x < TEX_SIZE; x += TILE_SIZE) {
+            Tile t = { s->texture, TEX_SIZE, x, y, TILE_SIZE, TILE_SIZE, 1.0f };
+            tile_blit(&t, &image, &shadow, black);
+            tile_blit(&t, &image, &face, gold);
+        }
+    }
+    free_tile_image(&image);
+    return 0;
+}
+
+static int rotozoom_init(Effect* fx, SDL_Renderer* renderer) {
+    RotozoomState* s = calloc(1, sizeof(RotozoomState));
+    if (!s) return 1;
+    fx->state = s;
+    fx->view = &s->view;
+    fx->view_size = sizeof(RotozoomView);
+    return build_texture(s);
+}
+
+static void rotozoom_update(Effect* fx, float dt) {
+    RotozoomState* s = fx->state;
+    RotozoomView* v = &s->view;
+    s->time += dt;
+    v->angle = fmodf(v->angle + fx->params[0] * dt, 2.0f * (float)M_PI);
+    v->zoom = fx->params[1] * (1.25f + sinf(s->time * ZOOM_RATE));
+    v->u = fmodf(v->u + PAN_U * dt, TEX_SIZE);
+    v->v = fmodf(v->v + PAN_V * dt, TEX_SIZE);
+    v->detail = current_quality()->detail;
+}
+
+// Fill one tile or band; may run on any thread
+static void rotozoom_area(void* ctx, const Tile* t) {
+    const RotozoomFrame* f = ctx;
+    for (int y = t->y; y < t->y + t->h; y++) {
+        Uint32 u = f->u + f->du * t->x - f->dv * y;
+        Uint32 v = f->v + f->dv * t->x + f->du * y;
+        kernels->rotozoom_span(t->fb + (size_t)y * t->pitch + t->x, u, v, f->du, f->dv,
+                               f->level, f->texture, t->w);
+    }
+}
+
+// The centre of a w x h pixel grid at `scale` pixels per view unit shows
+// the view's centre texel
+static void make_frame(const RotozoomState* s, const EffectFrame* frame, int w, int h, float scale,
+                       RotozoomFrame* out) {
+    const RotozoomView* v = frame->view;
+    float step = 65536.0f / (SDL_max(v->zoom, 0.01f) * scale); // Texels per pixel, 16.16
+    out->texture = s->texture;
+    out->du = (Uint32)(Sint32)(cosf(v->angle) * step);
+    out->dv = (Uint32)(Sint32)(sinf(v->angle) * step);
+    Uint32 cx = (Uint32)(w / 2), cy = (Uint32)(h / 2);
+    out->u = (Uint32)(v->u * 65536.0f) - out->du * cx + out->dv * cy;
+    out->v = (Uint32)(v->v * 65536.0f) - out->dv * cx - out->du * cy;
+    out->level = (Uint32)(frame->alpha * 256);
+}
+
+// Drawn into a streaming texture, at half resolution below full detail
+static void rotozoom_render(Effect* fx, const EffectFrame* frame, SDL_Renderer* renderer) {
+    RotozoomState* s = fx->state;
+    int shift = ((const RotozoomView*)frame->view)->detail >= 2 ? 0 : 1;
+    float scale = get_render_scale();
+    int w = SDL_max((int)(screen_width() * scale) >> shift, 1);
+    int h = SDL_max((int)(screen_height() * scale) >> shift, 1);
+    float px = view_to_pixels() * scale / (1 << shift);
+
+    RotozoomFrame f;
+    make_frame(s, frame, w, h, px, &f);
+    if (draw_tile_layer(renderer, &s->layer, w, h, px, rotozoom_area, &f) != 0) return;
+
+    SDL_Color white = { 255, 255, 255, 255 };
+    cmd_copy(s->layer.texture, NULL, NULL, white, SDL_BLENDMODE_NONE); // The fade is in the level
+}
+
+static void rotozoom_render_tile(Effect* fx, const EffectFrame* frame, const Tile* tile) {
+    float scale = get_render_scale();
+    RotozoomFrame f;
+    make_frame(fx->state, frame, (int)(screen_width() * scale), (int)(screen_height() * scale), tile->scale, &f);
+    rotozoom_area(&f, tile);
+}
+
+static void rotozoom_destroy(Effect* fx) {
+    RotozoomState* s = fx->state;
+    if (!s) return;
+    free_tile_layer(&s->layer);
+    free(s);
+}
+
+Effect rotozoom_effect = { "rotozoom", rotozoom_init, rotozoom_update, rotozoom_render, rotozoom_destroy, NULL, rotozoom_render_tile };
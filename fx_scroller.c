@@ -0,0 +1,160 @@
+/*
+ * fx_scroller.c - Colour-cycling sine-wave text scroller.
+ */
+
+#include <SDL.h>
+#include <SDL_ttf.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <math.h>
+#include "demo.h"
+#include "effect.h"
+#include "cmdbuf.h"
+
+#define SCROLLER_FONT_SIZE 24 // Matches the main font opened in main.c
+
+// Published to the render thread every step
+typedef struct {
+    int x, y;
+} ScrollerView;
+
+typedef struct {
+    SDL_Texture* texture; // Rasterized for the current window size (main thread)
+    TileImage image;      // CPU copy of the texture for the tile renderer
+    int font_px;          // Point size the texture was rasterized at
+    int text_w, text_h;   // Text size in view units, fixed after init
+    float scroll_x;
+    float time_counter;
+    ScrollerView view;
+} ScrollerState;
+
+static const char* scrollText = "GREETINGS FROM A C AND SDL2 DEMO... NOW WITH MUSIC, RASTER BARS AND COLOR CYCLING TEXT... ENJOY THE SHOW...";
+static SDL_Color textColor = { 0, 255, 0, 255 }; // Initial color, will be modulated
+
+
+// Create the text texture to be rendered, plus its CPU copy when tiles are on
+static SDL_Texture* create_text_texture(SDL_Renderer* renderer, TTF_Font* textFont, const char* text,
+                                        TileImage* image, int* w, int* h) {
+    SDL_Surface* textSurface = TTF_RenderText_Blended(textFont, text, textColor);
+    if (!textSurface) {
+        printf("Unable to render text surface! TTF_Error: %s\n", TTF_GetError());
+        return NULL;
+    }
+
+    SDL_Texture* texture = SDL_CreateTextureFromSurface(renderer, textSurface);
+    if (!texture) {
+        printf("Unable to create texture from rendered text! SDL_Error: %s\n", SDL_GetError());
+    }
+
+    if (texture && tiles_enabled() && tile_image_from_surface(image, textSurface) != 0) {
+        SDL_DestroyTexture(texture);
+        texture = NULL;
+    }
+
+    *w = textSurface->w;
+    *h = textSurface->h;
+
+    SDL_FreeSurface(textSurface);
+    return texture;
+}
+
+static int scroller_init(Effect* fx, SDL_Renderer* renderer) {
+    ScrollerState* s = calloc(1, sizeof(ScrollerState));
+    if (!s) return 1;
+    fx->state = s;
+    fx->view = &s->view;
+    fx->view_size = sizeof(ScrollerView);
+
+    // The 24pt main font defines the text's size in view units
+    s->texture = create_text_texture(renderer, font, scrollText, &s->image, &s->text_w, &s->text_h);
+    if (!s->texture) return 1;
+    s->font_px = SCROLLER_FONT_SIZE;
+    s->scroll_x = view_width();
+    s->view.x = view_width();
+
+    // Colour cycling is applied as the layer tint, so the layer only needs
+    // redrawing when the text actually moves
+    fx->layered = 1;
+    return 0;
+}
+
+static void scroller_update(Effect* fx, float dt) {
+    ScrollerState* s = fx->state;
+    s->scroll_x -= fx->params[0] * dt;
+    if (s->scroll_x < -s->text_w) {
+        s->scroll_x = view_width();
+    }
+    s->time_counter += 3.0f * dt; // 0.05 per 60 Hz frame
+
+    // Calculate color modulation based on time
+    float t = s->time_counter;
+    fx->tint = color_cycle(t);
+
+    // Calculate position with sine wave
+    int x = (int)s->scroll_x;
+    int y = (int)((VIEW_HEIGHT / 2) - (s->text_h / 2) + (sin(t * 2.0f) * (VIEW_HEIGHT * fx->params[1])));
+    if (x != s->view.x || y != s->view.y) {
+        s->view.x = x;
+        s->view.y = y;
+        fx->dirty = 1;
+    }
+}
+
+// Render the scrolling text with a sine wave and color cycling
+static void scroller_render(Effect* fx, const EffectFrame* frame, SDL_Renderer* renderer) {
+    const ScrollerState* s = fx->state; // Only the texture and its size, fixed after init
+    const ScrollerView* v = frame->view;
+
+    // Inside a layer there is nothing underneath, so the text alpha is copied as-is
+    SDL_Color mod = { 255, 255, 255, 255 };
+    SDL_BlendMode blend = SDL_BLENDMODE_NONE;
+    if (!fx->layer) {
+        mod = frame->tint;
+        mod.a = (Uint8)(255 * frame->alpha);
+        blend = SDL_BLENDMODE_BLEND;
+    }
+
+    SDL_Rect destRect = { v->x, v->y, s->text_w, s->text_h };
+    cmd_copy(s->texture, NULL, &destRect, mod, blend);
+}
+
+static void scroller_render_tile(Effect* fx, const EffectFrame* frame, const Tile* tile) {
+    const ScrollerState* s = fx->state;
+    const ScrollerView* v = frame->view;
+    SDL_Color mod = frame->tint;
+    mod.a = (Uint8)(255 * frame->alpha);
+
+    SDL_Rect destRect = { v->x, v->y, s->text_w, s->text_h };
+    tile_blit(tile, &s->image, &destRect, mod);
+}
+
+// Re-rasterize the text so it stays sharp at the new window height
+static void scroller_resize(Effect* fx, SDL_Renderer* renderer) {
+    ScrollerState* s = fx->state;
+    int px = (int)(SCROLLER_FONT_SIZE * view_to_pixels() + 0.5f);
+    if (px < 1 || px == s->font_px) return;
+
+    TTF_Font* sized = TTF_OpenFont("font.ttf", px);
+    if (!sized) return; // Keep stretching the old texture
+    int w, h;
+    TileImage image = { NULL, 0, 0 };
+    SDL_Texture* texture = create_text_texture(renderer, sized, scrollText, &image, &w, &h);
+    TTF_CloseFont(sized);
+    if (!texture) return;
+
+    SDL_DestroyTexture(s->texture);
+    free_tile_image(&s->image);
+    s->texture = texture;
+    s->image = image;
+    s->font_px = px;
+}
+
+static void scroller_destroy(Effect* fx) {
+    ScrollerState* s = fx->state;
+    if (!s) return;
+    if (s->texture) SDL_DestroyTexture(s->texture);
+    free_tile_image(&s->image);
+    free(s);
+}
+
+Effect scroller_effect = { "scroller", scroller_init, scroller_update, scroller_render, scroller_destroy, scroller_resize, scroller_render_tile };
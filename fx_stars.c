@@ -0,0 +1,144 @@
+/*
+ * fx_stars.c - 3D starfield effect.
+ *
+ * With a trail set the stars leave streaks: the star layer is faded rather
+ * than cleared between steps (effect.h), so a streak costs one full-layer
+ * blend per frame however long it is. The CPU tile path has no layers to
+ * keep and draws the stars without trails.
+ *
+ * prepare() projects the field once per drawn frame; render() and every
+ * tile's render_tile() only read the finished rectangles.
+ */
+
+#include <SDL.h>
+#include <stdlib.h>
+#include "demo.h"
+#include "effect.h"
+#include "cmdbuf.h"
+#include "governor.h"
+#include "kernels.h"
+
+// --- Constants ---
+#define NUM_STARS 500
+#define STAR_SPREAD 512
+#define MAX_TRAIL 0.95f // Share of the streaks kept per 1/60 s; 1 would never fade
+
+// --- Structs ---
+// Structure of arrays, so the kernels (kernels.h) can work on whole vectors
+typedef struct {
+    float x[NUM_STARS], y[NUM_STARS], z[NUM_STARS];
+    float speed[NUM_STARS];
+    int count; // Stars in use at the current quality level
+} StarsView;
+
+// Projection constants for the current window, main thread only
+typedef struct {
+    float cx, cy;       // Screen centre in view units
+    int max_x, max_y;   // Visible bounds in view units
+} StarsProjection;
+
+typedef struct {
+    StarsView view;
+    StarsProjection proj;
+    SDL_Rect rects[NUM_STARS]; // This frame's on-screen stars, main thread only
+    int visible;
+} StarsState;
+
+
+// Initialize star positions randomly
+static int stars_init(Effect* fx, SDL_Renderer* renderer) {
+    StarsState* s = calloc(1, sizeof(StarsState));
+    if (!s) return 1;
+    fx->state = s;
+    fx->view = &s->view;
+    fx->view_size = sizeof(StarsView);
+    fx->layered = 1; // Cached while the field is paused (speed 0)
+
+    // Seeded once in main.c, with a fixed seed in deterministic mode
+    StarsView* v = &s->view;
+    for (int i = 0; i < NUM_STARS; i++) {
+        v->x[i] = (float)(rand() % STAR_SPREAD) - (STAR_SPREAD / 2);
+        v->y[i] = (float)(rand() % STAR_SPREAD) - (STAR_SPREAD / 2);
+        v->z[i] = (float)(rand() % STAR_SPREAD);
+        v->speed[i] = ((float)(rand() % 100) / 200.0f) + 0.2f;
+    }
+    return 0;
+}
+
+// Update star positions to move them towards the camera
+static void stars_update(Effect* fx, float dt) {
+    StarsView* s = &((StarsState*)fx->state)->view;
+    fx->trail = SDL_max(0.0f, SDL_min(fx->params[1], 1.0f)) * MAX_TRAIL;
+    int count = (int)(NUM_STARS * current_quality()->star_fraction);
+    if (count != s->count) {
+        s->count = count;
+        fx->dirty = 1;
+    }
+
+    float step = fx->params[0] * dt * 60.0f; // Speeds are in units per 60 Hz frame
+    if (step == 0.0f) return;
+    fx->dirty = 1;
+
+    kernels->advance_stars(s->z, s->speed, count, step);
+    for (int i = 0; i < count; i++) {
+        if (s->z[i] <= 0) {
+            s->x[i] = (float)(rand() % STAR_SPREAD) - (STAR_SPREAD / 2);
+            s->y[i] = (float)(rand() % STAR_SPREAD) - (STAR_SPREAD / 2);
+            s->z[i] = STAR_SPREAD;
+        }
+    }
+}
+
+// Recompute the projection constants for the new window shape
+static void stars_resize(Effect* fx, SDL_Renderer* renderer) {
+    StarsProjection* p = &((StarsState*)fx->state)->proj;
+    p->max_x = view_width();
+    p->max_y = VIEW_HEIGHT;
+    p->cx = p->max_x / 2.0f;
+    p->cy = p->max_y / 2.0f;
+}
+
+// 2D projection of all stars; returns how many landed on screen
+static int project_stars(const StarsView* s, const StarsProjection* p, SDL_Rect* out) {
+    float px[NUM_STARS], py[NUM_STARS], size[NUM_STARS];
+    kernels->project_stars(s->x, s->y, s->z, s->count, p->cx, p->cy, STAR_SPREAD, px, py, size);
+
+    int visible = 0;
+    for (int i = 0; i < s->count; i++) {
+        if (s->z[i] <= 0) continue; // Behind the camera
+        int x = (int)px[i], y = (int)py[i];
+        if (x < 0 || x >= p->max_x || y < 0 || y >= p->max_y) continue;
+        out[visible++] = (SDL_Rect){ x, y, (int)size[i], (int)size[i] };
+    }
+    return visible;
+}
+
+// Project once per frame, before the GPU path or the tiles read the result
+static void stars_prepare(Effect* fx, const EffectFrame* frame) {
+    StarsState* s = fx->state;
+    s->visible = project_stars(frame->view, &s->proj, s->rects);
+}
+
+// Render the stars projected by prepare()
+static void stars_render(Effect* fx, const EffectFrame* frame, SDL_Renderer* renderer) {
+    const StarsState* s = fx->state;
+    // Layers are faded by the compositor; without one, fade towards the black background
+    Uint8 level = fx->layer ? 255 : (Uint8)(255 * frame->alpha);
+    SDL_Color white = { level, level, level, 255 };
+    for (int i = 0; i < s->visible; i++) cmd_fill_rect(&s->rects[i], white, SDL_BLENDMODE_NONE);
+}
+
+// Same stars, clipped to one tile of the CPU framebuffer
+static void stars_render_tile(Effect* fx, const EffectFrame* frame, const Tile* tile) {
+    const StarsState* s = fx->state;
+    Uint8 level = (Uint8)(255 * frame->alpha);
+    SDL_Color white = { level, level, level, 255 };
+    for (int i = 0; i < s->visible; i++) tile_fill_rect(tile, &s->rects[i], white);
+}
+
+static void stars_destroy(Effect* fx) {
+    free(fx->state);
+}
+
+Effect stars_effect = { "stars", stars_init, stars_update, stars_render, stars_destroy, stars_resize, stars_render_tile,
+                        stars_prepare };
@@ -0,0 +1,174 @@
+/*
+ * fx_title.c - Static title card.
+ *
+ * The outlined title is built from a dozen text copies, but it never
+ * changes, so it is drawn into its layer once and every later frame is a
+ * single composite of the cached layer (fades included).
+ */
+
+#include <SDL.h>
+#include <SDL_ttf.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include "demo.h"
+#include "effect.h"
+#include "cmdbuf.h"
+#include "governor.h"
+
+// --- Constants ---
+#define TITLE_FONT_SIZE 56
+#define TITLE_OUTLINE 3
+
+typedef struct {
+    int detail; // The outline ring is dropped at detail 0
+} TitleView;
+
+typedef struct {
+    SDL_Texture* text;    // Rasterized for the current window size (main thread)
+    SDL_Texture* outline;
+    TileImage text_image; // CPU copies for the tile renderer
+    TileImage outline_image;
+    int font_px;
+    int w, h;             // Title size in view units, fixed after init
+    TitleView view;
+} TitleState;
+
+static const char* titleText = "C SCROLLER DEMO";
+
+
+static SDL_Texture* render_title_text(SDL_Renderer* renderer, TTF_Font* big, SDL_Color color, TileImage* image) {
+    SDL_Surface* surface = TTF_RenderText_Blended(big, titleText, color);
+    if (!surface) {
+        printf("Unable to render title text! TTF_Error: %s\n", TTF_GetError());
+        return NULL;
+    }
+    SDL_Texture* texture = SDL_CreateTextureFromSurface(renderer, surface);
+    if (texture && tiles_enabled() && tile_image_from_surface(image, surface) != 0) {
+        SDL_DestroyTexture(texture);
+        texture = NULL;
+    }
+    SDL_FreeSurface(surface);
+    return texture;
+}
+
+// Rasterize face and outline at the given point size
+static int rasterize_title(TitleState* s, SDL_Renderer* renderer, int px) {
+    TTF_Font* big = TTF_OpenFont("font.ttf", px);
+    if (!big) {
+        printf("Failed to load title font! TTF_Error: %s\n", TTF_GetError());
+        return 1;
+    }
+    SDL_Color face = { 255, 230, 120, 255 };
+    SDL_Color edge = { 40, 0, 80, 255 };
+    TileImage text_image = { NULL, 0, 0 };
+    TileImage outline_image = { NULL, 0, 0 };
+    SDL_Texture* text = render_title_text(renderer, big, face, &text_image);
+    SDL_Texture* outline = render_title_text(renderer, big, edge, &outline_image);
+    TTF_CloseFont(big);
+    if (!text || !outline) {
+        if (text) SDL_DestroyTexture(text);
+        if (outline) SDL_DestroyTexture(outline);
+        free_tile_image(&text_image);
+        free_tile_image(&outline_image);
+        return 1;
+    }
+
+    if (s->text) SDL_DestroyTexture(s->text);
+    if (s->outline) SDL_DestroyTexture(s->outline);
+    free_tile_image(&s->text_image);
+    free_tile_image(&s->outline_image);
+    s->text = text;
+    s->outline = outline;
+    s->text_image = text_image;
+    s->outline_image = outline_image;
+    s->font_px = px;
+    return 0;
+}
+
+static int title_init(Effect* fx, SDL_Renderer* renderer) {
+    TitleState* s = calloc(1, sizeof(TitleState));
+    if (!s) return 1;
+    fx->state = s;
+    fx->view = &s->view;
+    fx->view_size = sizeof(TitleView);
+    fx->layered = 1;
+    s->view.detail = current_quality()->detail;
+
+    // The base size defines the title's size in view units
+    if (rasterize_title(s, renderer, TITLE_FONT_SIZE) != 0) return 1;
+    SDL_QueryTexture(s->text, NULL, NULL, &s->w, &s->h);
+    return 0;
+}
+
+// Keep the title sharp at the new window height; the layer is redrawn anyway
+static void title_resize(Effect* fx, SDL_Renderer* renderer) {
+    TitleState* s = fx->state;
+    int px = (int)(TITLE_FONT_SIZE * view_to_pixels() + 0.5f);
+    if (px >= 1 && px != s->font_px) rasterize_title(s, renderer, px);
+}
+
+// Only a quality change can alter the cached title
+static void title_update(Effect* fx, float dt) {
+    TitleState* s = fx->state;
+    int detail = current_quality()->detail;
+    if (detail != s->view.detail) {
+        s->view.detail = detail;
+        fx->dirty = 1;
+    }
+}
+
+// Outline ring plus drop shadow, then the face on top
+static void title_render(Effect* fx, const EffectFrame* frame, SDL_Renderer* renderer) {
+    const TitleState* s = fx->state; // Textures and size, fixed after init
+    const TitleView* v = frame->view;
+    int x = (view_width() - s->w) / 2;
+    int y = (int)(VIEW_HEIGHT * frame->params[0]) - s->h / 2;
+
+    SDL_Color mod = { 255, 255, 255, fx->layer ? 255 : (Uint8)(255 * frame->alpha) };
+
+    for (int dy = -TITLE_OUTLINE; v->detail > 0 && dy <= TITLE_OUTLINE; dy += TITLE_OUTLINE) {
+        for (int dx = -TITLE_OUTLINE; dx <= TITLE_OUTLINE; dx += TITLE_OUTLINE) {
+            SDL_Rect r = { x + dx, y + dy, s->w, s->h };
+            cmd_copy(s->outline, NULL, &r, mod, SDL_BLENDMODE_BLEND);
+        }
+    }
+    SDL_Rect shadow = { x + 2 * TITLE_OUTLINE, y + 2 * TITLE_OUTLINE, s->w, s->h };
+    cmd_copy(s->outline, NULL, &shadow, mod, SDL_BLENDMODE_BLEND);
+
+    // The face must land on top of the outline copies
+    cmd_next_group();
+    SDL_Rect face = { x, y, s->w, s->h };
+    cmd_copy(s->text, NULL, &face, mod, SDL_BLENDMODE_BLEND);
+}
+
+// Same layering as title_render, one tile at a time
+static void title_render_tile(Effect* fx, const EffectFrame* frame, const Tile* tile) {
+    const TitleState* s = fx->state;
+    const TitleView* v = frame->view;
+    int x = (view_width() - s->w) / 2;
+    int y = (int)(VIEW_HEIGHT * frame->params[0]) - s->h / 2;
+    SDL_Color mod = { 255, 255, 255, (Uint8)(255 * frame->alpha) };
+
+    for (int dy = -TITLE_OUTLINE; v->detail > 0 && dy <= TITLE_OUTLINE; dy += TITLE_OUTLINE) {
+        for (int dx = -TITLE_OUTLINE; dx <= TITLE_OUTLINE; dx += TITLE_OUTLINE) {
+            SDL_Rect r = { x + dx, y + dy, s->w, s->h };
+            tile_blit(tile, &s->outline_image, &r, mod);
+        }
+    }
+    SDL_Rect shadow = { x + 2 * TITLE_OUTLINE, y + 2 * TITLE_OUTLINE, s->w, s->h };
+    tile_blit(tile, &s->outline_image, &shadow, mod);
+    SDL_Rect face = { x, y, s->w, s->h };
+    tile_blit(tile, &s->text_image, &face, mod);
+}
+
+static void title_destroy(Effect* fx) {
+    TitleState* s = fx->state;
+    if (!s) return;
+    if (s->text) SDL_DestroyTexture(s->text);
+    if (s->outline) SDL_DestroyTexture(s->outline);
+    free_tile_image(&s->text_image);
+    free_tile_image(&s->outline_image);
+    free(s);
+}
+
+Effect title_effect = { "title", title_init, title_update, title_render, title_destroy, title_resize, title_render_tile };
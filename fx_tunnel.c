@@ -0,0 +1,191 @@
+/*
+ * fx_tunnel.c - Textured tunnel from precomputed angle and distance tables.
+ *
+ * The angle of every pixel around the screen centre and the inverse of its
+ * distance from it are worked out once per output size and stored as a
+ * texture coordinate (u around, v along the tunnel) plus a fog shade. A
+ * frame is then only a texture lookup at those coordinates plus an offset
+ * that moves and twists the tunnel (kernels->tunnel_span).
+ *
+ * The tables match the pixel grid they were built for: the GPU path's
+ * streaming texture, rebuilt when that changes size, or the CPU
+ * framebuffer, rebuilt in the resize hook.
+ */
+
+#include <SDL.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <math.h>
+#include "demo.h"
+#include "effect.h"
+#include "cmdbuf.h"
+#include "governor.h"
+#include "jobs.h"
+#include "kernels.h"
+
+// --- Constants ---
+#define TEX_SIZE 256        // Texture is TEX_SIZE x TEX_SIZE; coordinates are bytes
+#define TUNNEL_DEPTH 40.0f  // v = TUNNEL_DEPTH / radius in view units, in texture repeats
+#define TUNNEL_TURNS 2      // Texture repeats around the tunnel
+#define FOG_RADIUS 260.0f   // Radius in view units where the fog has cleared
+
+// --- Structs ---
+typedef struct {
+    float depth, turn; // Texture scroll along and around the tunnel, in texels
+    int detail;
+} TunnelView;
+
+// Per-pixel lookup, main thread; fixed while a frame is drawn
+typedef struct {
+    Uint16* uv;   // v << 8 | u
+    Uint8* shade; // Fog, 0 (black) to 255
+    int w, h;
+    float scale;  // Pixels per view unit
+} TunnelTables;
+
+typedef struct {
+    TunnelView view;
+    TunnelTables tables;
+    TileLayer layer; // GPU path
+    Uint32 texture[TEX_SIZE * TEX_SIZE];
+} TunnelState;
+
+// Everything a tile needs
+typedef struct {
+    const TunnelTables* tables;
+    const Uint32* texture;
+    Uint32 offset;
+    Uint32 level;
+} TunnelFrame;
+
+
+static int tunnel_init(Effect* fx, SDL_Renderer* renderer) {
+    TunnelState* s = calloc(1, sizeof(TunnelState));
+    if (!s) return 1;
+    fx->state = s;
+    fx->view = &s->view;
+    fx->view_size = sizeof(TunnelView);
+
+    // XOR pattern, colour-cycling along the tunnel
+    for (int v = 0; v < TEX_SIZE; v++) {
+        SDL_Color c = color_cycle(v * 4.0f * (float)M_PI / TEX_SIZE);
+        for (int u = 0; u < TEX_SIZE; u++) {
+            Uint32 k = ((Uint32)(u ^ v) << 3 & 0xff) | 0x40;
+            s->texture[v * TEX_SIZE + u] = 0xff000000 | (c.r * k >> 8) << 16 | (c.g * k >> 8) << 8 | (c.b * k >> 8);
+        }
+    }
+    return 0;
+}
+
+static void tunnel_update(Effect* fx, float dt) {
+    TunnelView* v = &((TunnelState*)fx->state)->view;
+    v->depth = fmodf(v->depth + fx->params[0] * dt, TEX_SIZE);
+    v->turn = fmodf(v->turn + fx->params[1] * dt + TEX_SIZE, TEX_SIZE);
+    v->detail = current_quality()->detail;
+}
+
+static void build_rows(void* ctx, int index) {
+    TunnelTables* t = ctx;
+    float cx = t->w / 2.0f, cy = t->h / 2.0f;
+    int y1 = SDL_min(t->h, (index + 1) * TILE_SIZE);
+    for (int y = index * TILE_SIZE; y < y1; y++) {
+        for (int x = 0; x < t->w; x++) {
+            float dx = (x + 0.5f - cx) / t->scale, dy = (y + 0.5f - cy) / t->scale;
+            float r = SDL_max(sqrtf(dx * dx + dy * dy), 1.0f);
+            int u = (int)floorf(atan2f(dy, dx) * (TUNNEL_TURNS * TEX_SIZE / (2.0f * (float)M_PI)));
+            int v = (int)(TUNNEL_DEPTH * TEX_SIZE / r);
+            size_t i = (size_t)y * t->w + x;
+            t->uv[i] = (Uint16)((v & 0xff) << 8 | (u & 0xff));
+            t->shade[i] = (Uint8)SDL_min(255.0f, r * (255.0f / FOG_RADIUS));
+        }
+    }
+}
+
+// Rebuild the tables for a w x h pixel grid, rows in parallel on the job pool
+static int build_tables(Effect* fx, int w, int h, float scale) {
+    TunnelTables* t = &((TunnelState*)fx->state)->tables;
+    w = SDL_max(w, 1);
+    h = SDL_max(h, 1);
+    if (w == t->w && h == t->h && scale == t->scale) return 0;
+
+    free(t->uv);
+    free(t->shade);
+    t->uv = malloc(sizeof(Uint16) * w * h);
+    t->shade = malloc((size_t)w * h);
+    if (!t->uv || !t->shade) {
+        printf("Could not allocate %dx%d tunnel tables\n", w, h);
+        free(t->uv);
+        free(t->shade);
+        *t = (TunnelTables){ NULL, NULL, 0, 0, 0.0f };
+        fx->table_bytes = 0;
+        return 1;
+    }
+    t->w = w;
+    t->h = h;
+    t->scale = scale;
+    run_jobs(build_rows, t, (h + TILE_SIZE - 1) / TILE_SIZE);
+    fx->table_bytes = (sizeof(Uint16) + 1) * (size_t)w * h;
+    return 0;
+}
+
+// The CPU framebuffer's grid; the GPU path sizes its tables when drawing
+static void tunnel_resize(Effect* fx, SDL_Renderer* renderer) {
+    if (!tiles_enabled()) return;
+    float scale = get_render_scale();
+    build_tables(fx, (int)(screen_width() * scale), (int)(screen_height() * scale), view_to_pixels() * scale);
+}
+
+// Fill one tile or band; may run on any thread
+static void tunnel_area(void* ctx, const Tile* t) {
+    const TunnelFrame* f = ctx;
+    const TunnelTables* tab = f->tables;
+    if (!tab->uv || t->x + t->w > tab->w || t->y + t->h > tab->h) return;
+    for (int y = t->y; y < t->y + t->h; y++) {
+        size_t i = (size_t)y * tab->w + t->x;
+        kernels->tunnel_span(t->fb + (size_t)y * t->pitch + t->x, tab->uv + i, tab->shade + i,
+                             f->offset, f->level, f->texture, t->w);
+    }
+}
+
+static void make_frame(const TunnelState* s, const EffectFrame* frame, TunnelFrame* out) {
+    const TunnelView* v = frame->view;
+    out->tables = &s->tables;
+    out->texture = s->texture;
+    out->offset = ((Uint32)v->depth & 0xff) << 8 | ((Uint32)v->turn & 0xff);
+    out->level = (Uint32)(frame->alpha * 256);
+}
+
+// Drawn into a streaming texture, at half resolution below full detail
+static void tunnel_render(Effect* fx, const EffectFrame* frame, SDL_Renderer* renderer) {
+    TunnelState* s = fx->state;
+    int shift = ((const TunnelView*)frame->view)->detail >= 2 ? 0 : 1;
+    float scale = get_render_scale();
+    int w = (int)(screen_width() * scale) >> shift;
+    int h = (int)(screen_height() * scale) >> shift;
+    float px = view_to_pixels() * scale / (1 << shift);
+    if (build_tables(fx, w, h, px) != 0) return;
+
+    TunnelFrame f;
+    make_frame(s, frame, &f);
+    if (draw_tile_layer(renderer, &s->layer, s->tables.w, s->tables.h, px, tunnel_area, &f) != 0) return;
+
+    SDL_Color white = { 255, 255, 255, 255 };
+    cmd_copy(s->layer.texture, NULL, NULL, white, SDL_BLENDMODE_NONE); // The fade is in the shade
+}
+
+static void tunnel_render_tile(Effect* fx, const EffectFrame* frame, const Tile* tile) {
+    TunnelFrame f;
+    make_frame(fx->state, frame, &f);
+    tunnel_area(&f, tile);
+}
+
+static void tunnel_destroy(Effect* fx) {
+    TunnelState* s = fx->state;
+    if (!s) return;
+    free_tile_layer(&s->layer);
+    free(s->tables.uv);
+    free(s->tables.shade);
+    free(s);
+}
+
+Effect tunnel_effect = { "tunnel", tunnel_init, tunnel_update, tunnel_render, tunnel_destroy, tunnel_resize, tunnel_render_tile };
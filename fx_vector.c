@@ -0,0 +1,364 @@
+/*
+ * fx_vector.c - Rotating 3D object, filled, wireframe or both.
+ *
+ * The object is a cube, a torus or object.obj from the working directory.
+ * Its vertices are kept as structure of arrays, so the rotation is a
+ * single 3x4 matrix pass over whole vectors (kernels->transform_points),
+ * followed by the stars' 128 / z projection (kernels->project_stars).
+ * Faces turned away from the camera are dropped before anything else is
+ * done with them, the rest are flat shaded and sorted back to front, and
+ * the whole object goes to the command buffer as one triangle list: a
+ * single SDL_RenderGeometry call. Wireframe edges are thin quads in the
+ * same list. On the CPU path every tile fills the triangles crossing it.
+ *
+ * The sim thread only turns the object; prepare() transforms and sorts it
+ * once per drawn frame for both paths.
+ */
+
+#include <SDL.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+#include "demo.h"
+#include "effect.h"
+#include "cmdbuf.h"
+#include "kernels.h"
+
+// --- Constants ---
+#define MAX_VERTICES 4096
+#define MAX_TRIANGLES 8192
+#define MAX_POLYGON 16         // Corners per OBJ face
+#define OBJECT_FILE "object.obj"
+#define OBJECT_RADIUS 100.0f   // Model units, same space as the stars
+#define OBJECT_DISTANCE 130.0f // Centre's distance from the camera
+#define NEAR_Z 8.0f            // Triangles closer than this are dropped
+#define TORUS_RINGS 32
+#define TORUS_SIDES 14
+#define TORUS_TUBE 0.32f       // Tube radius, share of the outer radius
+#define WIRE_WIDTH 1.5f        // Edge width, view units
+#define AMBIENT 0.25f
+
+enum { MESH_CUBE, MESH_TORUS, MESH_FILE, MESH_COUNT };
+
+// --- Structs ---
+typedef struct {
+    float x[MAX_VERTICES], y[MAX_VERTICES], z[MAX_VERTICES];
+    int vertex_count;
+    Uint16 tris[MAX_TRIANGLES][3];
+    Uint8 edges[MAX_TRIANGLES]; // Bit k: edge from corner k to k + 1 is drawn in wireframe
+    int tri_count;
+} Mesh;
+
+typedef struct {
+    float m[12];     // Model to camera, see kernels.h
+    int mesh;
+    float wire;      // 0 filled .. 1 wireframe
+    SDL_Color color;
+} VectorView;
+
+// A front face waiting to be sorted
+typedef struct {
+    float depth;
+    int tri;
+    float shade;
+} Face;
+
+typedef struct {
+    VectorView view;
+    float angle[3], time;
+    Mesh* meshes[MESH_COUNT]; // Fixed after init; the file's is NULL without one
+    // Main thread from here on
+    float cx[MAX_VERTICES], cy[MAX_VERTICES], cz[MAX_VERTICES]; // Camera space
+    float px[MAX_VERTICES], py[MAX_VERTICES], size[MAX_VERTICES];
+    Face faces[MAX_TRIANGLES];
+    CmdVertex* verts;  // Triangle list for this frame, view units
+    int vert_count;
+} VectorState;
+
+// Per face one fill and three edge quads
+#define MAX_LIST_VERTICES (MAX_TRIANGLES * (3 + 3 * 6))
+
+
+// Fan from the first corner; only the polygon's own sides are edges
+static void add_polygon(Mesh* m, const int* idx, int n) {
+    for (int i = 1; i + 1 < n && m->tri_count < MAX_TRIANGLES; i++) {
+        int t = m->tri_count++;
+        m->tris[t][0] = (Uint16)idx[0];
+        m->tris[t][1] = (Uint16)idx[i];
+        m->tris[t][2] = (Uint16)idx[i + 1];
+        m->edges[t] = (i == 1 ? 1 : 0) | 2 | (i + 2 == n ? 4 : 0);
+    }
+}
+
+// Centre on the bounding box and scale to OBJECT_RADIUS
+static void normalize_mesh(Mesh* m) {
+    float lo[3] = { 1e30f, 1e30f, 1e30f }, hi[3] = { -1e30f, -1e30f, -1e30f };
+    float* axes[3] = { m->x, m->y, m->z };
+    for (int a = 0; a < 3; a++) {
+        for (int i = 0; i < m->vertex_count; i++) {
+            lo[a] = SDL_min(lo[a], axes[a][i]);
+            hi[a] = SDL_max(hi[a], axes[a][i]);
+        }
+    }
+    float r2 = 0.0f;
+    for (int i = 0; i < m->vertex_count; i++) {
+        for (int a = 0; a < 3; a++) axes[a][i] -= (lo[a] + hi[a]) * 0.5f;
+        r2 = SDL_max(r2, m->x[i] * m->x[i] + m->y[i] * m->y[i] + m->z[i] * m->z[i]);
+    }
+    float k = r2 > 0.0f ? OBJECT_RADIUS / sqrtf(r2) : 1.0f;
+    for (int i = 0; i < m->vertex_count; i++) {
+        m->x[i] *= k;
+        m->y[i] *= k;
+        m->z[i] *= k;
+    }
+}
+
+// Corners are counter-clockwise seen from outside
+static void build_cube(Mesh* m) {
+    static const int quads[6][4] = {
+        { 4, 5, 7, 6 }, { 0, 2, 3, 1 }, { 1, 3, 7, 5 }, { 0, 4, 6, 2 }, { 2, 6, 7, 3 }, { 0, 1, 5, 4 },
+    };
+    for (int i = 0; i < 8; i++) {
+        m->x[i] = i & 1 ? 1.0f : -1.0f;
+        m->y[i] = i & 2 ? 1.0f : -1.0f;
+        m->z[i] = i & 4 ? 1.0f : -1.0f;
+    }
+    m->vertex_count = 8;
+    for (int i = 0; i < 6; i++) add_polygon(m, quads[i], 4);
+}
+
+static void build_torus(Mesh* m) {
+    float ring = 1.0f - TORUS_TUBE;
+    for (int i = 0; i < TORUS_RINGS; i++) {
+        float u = 6.2831853f * i / TORUS_RINGS;
+        for (int j = 0; j < TORUS_SIDES; j++) {
+            float v = 6.2831853f * j / TORUS_SIDES;
+            int k = i * TORUS_SIDES + j;
+            float r = ring + TORUS_TUBE * cosf(v);
+            m->x[k] = r * cosf(u);
+            m->y[k] = TORUS_TUBE * sinf(v);
+            m->z[k] = r * sinf(u);
+        }
+    }
+    m->vertex_count = TORUS_RINGS * TORUS_SIDES;
+    for (int i = 0; i < TORUS_RINGS; i++) {
+        for (int j = 0; j < TORUS_SIDES; j++) {
+            int i1 = (i + 1) % TORUS_RINGS, j1 = (j + 1) % TORUS_SIDES;
+            int quad[4] = { i * TORUS_SIDES + j, i * TORUS_SIDES + j1, i1 * TORUS_SIDES + j1, i1 * TORUS_SIDES + j };
+            add_polygon(m, quad, 4);
+        }
+    }
+}
+
+// Vertices and faces of a Wavefront OBJ; everything else is ignored.
+// OBJ is y up with the viewer on +z, so y and z are flipped (a rotation,
+// which keeps the winding) to match the screen's y down and z forward
+static int load_obj(Mesh* m, const char* path) {
+    FILE* f = fopen(path, "r");
+    if (!f) return 1;
+    char line[512];
+    int failed = 0;
+    while (!failed && fgets(line, sizeof(line), f)) {
+        if (line[0] == 'v' && line[1] == ' ') {
+            if (m->vertex_count == MAX_VERTICES) {
+                printf("%s has more than %d vertices\n", path, MAX_VERTICES);
+                failed = 1;
+                break;
+            }
+            float x, y, z;
+            if (sscanf(line + 2, "%f %f %f", &x, &y, &z) != 3) continue;
+            m->x[m->vertex_count] = x;
+            m->y[m->vertex_count] = -y;
+            m->z[m->vertex_count] = -z;
+            m->vertex_count++;
+        } else if (line[0] == 'f' && line[1] == ' ') {
+            int idx[MAX_POLYGON], n = 0;
+            char* p = line + 2;
+            while (n < MAX_POLYGON) {
+                char* end;
+                long v = strtol(p, &end, 10);
+                if (end == p) break;
+                if (v < 0) v += m->vertex_count + 1; // Relative to the last vertex
+                if (v < 1 || v > m->vertex_count) {
+                    printf("%s refers to a missing vertex\n", path);
+                    failed = 1;
+                    break;
+                }
+                idx[n++] = (int)v - 1;
+                p = end;
+                while (*p && *p != ' ' && *p != '\t') p++; // Skip /texture/normal
+            }
+            if (!failed) add_polygon(m, idx, n);
+        }
+    }
+    fclose(f);
+    if (failed || m->tri_count == 0) return 1;
+    if (m->tri_count == MAX_TRIANGLES) printf("%s has more than %d triangles, drawing part of it\n", path, MAX_TRIANGLES);
+    return 0;
+}
+
+static int vector_init(Effect* fx, SDL_Renderer* renderer) {
+    VectorState* s = calloc(1, sizeof(VectorState));
+    if (!s) return 1;
+    fx->state = s;
+    fx->view = &s->view;
+    fx->view_size = sizeof(VectorView);
+
+    s->verts = malloc(sizeof(CmdVertex) * MAX_LIST_VERTICES);
+    for (int i = 0; i < MESH_COUNT; i++) s->meshes[i] = calloc(1, sizeof(Mesh));
+    if (!s->verts || !s->meshes[MESH_CUBE] || !s->meshes[MESH_TORUS] || !s->meshes[MESH_FILE]) {
+        printf("Could not allocate the vector object meshes\n");
+        return 1;
+    }
+    build_cube(s->meshes[MESH_CUBE]);
+    build_torus(s->meshes[MESH_TORUS]);
+    if (load_obj(s->meshes[MESH_FILE], OBJECT_FILE) != 0) {
+        free(s->meshes[MESH_FILE]);
+        s->meshes[MESH_FILE] = NULL; // Falls back to the torus
+    }
+    for (int i = 0; i < MESH_COUNT; i++) {
+        if (s->meshes[i]) normalize_mesh(s->meshes[i]);
+    }
+    return 0;
+}
+
+// Rotation about x, then y, then z; the object sits OBJECT_DISTANCE ahead
+static void vector_update(Effect* fx, float dt) {
+    VectorState* s = fx->state;
+    VectorView* v = &s->view;
+    static const float rates[3] = { 0.7f, 1.0f, 0.3f }; // Radians/s at speed 1
+    for (int i = 0; i < 3; i++) s->angle[i] = fmodf(s->angle[i] + rates[i] * fx->params[0] * dt, 6.2831853f);
+    s->time += dt;
+
+    float sx = sinf(s->angle[0]), cx = cosf(s->angle[0]);
+    float sy = sinf(s->angle[1]), cy = cosf(s->angle[1]);
+    float sz = sinf(s->angle[2]), cz = cosf(s->angle[2]);
+    float m[12] = {
+        cz * cy, cz * sy * sx - sz * cx, cz * sy * cx + sz * sx, 0.0f,
+        sz * cy, sz * sy * sx + cz * cx, sz * sy * cx - cz * sx, 0.0f,
+        -sy,     cy * sx,                cy * cx,                OBJECT_DISTANCE,
+    };
+    memcpy(v->m, m, sizeof(m));
+
+    int mesh = SDL_max(0, SDL_min((int)(fx->params[1] + 0.5f), MESH_COUNT - 1));
+    v->mesh = s->meshes[mesh] ? mesh : MESH_TORUS;
+    v->wire = SDL_max(0.0f, SDL_min(fx->params[2], 1.0f));
+    SDL_Color c = color_cycle(s->time * 0.25f);
+    v->color.r = (Uint8)(80 + c.r * 175 / 255);
+    v->color.g = (Uint8)(80 + c.g * 175 / 255);
+    v->color.b = (Uint8)(80 + c.b * 175 / 255);
+    v->color.a = 255;
+}
+
+static int farther_first(const void* pa, const void* pb) {
+    const Face* a = pa;
+    const Face* b = pb;
+    return a->depth > b->depth ? -1 : a->depth < b->depth;
+}
+
+static SDL_Color shaded(SDL_Color c, float shade, float alpha) {
+    SDL_Color out = { (Uint8)(c.r * shade), (Uint8)(c.g * shade), (Uint8)(c.b * shade), (Uint8)(255 * alpha) };
+    return out;
+}
+
+static void push_vertex(VectorState* s, float x, float y, SDL_Color c) {
+    CmdVertex* v = &s->verts[s->vert_count++];
+    v->x = x;
+    v->y = y;
+    v->color = c;
+}
+
+// A WIRE_WIDTH wide quad along the edge, as two triangles
+static void push_edge(VectorState* s, int a, int b, SDL_Color c) {
+    float dx = s->px[b] - s->px[a], dy = s->py[b] - s->py[a];
+    float len = sqrtf(dx * dx + dy * dy);
+    if (len < 0.01f) return;
+    float nx = -dy / len * (WIRE_WIDTH * 0.5f), ny = dx / len * (WIRE_WIDTH * 0.5f);
+    float x[4] = { s->px[a] + nx, s->px[b] + nx, s->px[b] - nx, s->px[a] - nx };
+    float y[4] = { s->py[a] + ny, s->py[b] + ny, s->py[b] - ny, s->py[a] - ny };
+    static const int order[6] = { 0, 1, 2, 0, 2, 3 };
+    for (int i = 0; i < 6; i++) push_vertex(s, x[order[i]], y[order[i]], c);
+}
+
+// Transform, project, cull, shade and sort: the triangle list both paths draw
+static void vector_prepare(Effect* fx, const EffectFrame* frame) {
+    VectorState* s = fx->state;
+    const VectorView* v = frame->view;
+    const Mesh* m = s->meshes[v->mesh];
+    s->vert_count = 0;
+    if (!m) return;
+
+    kernels->transform_points(m->x, m->y, m->z, m->vertex_count, v->m, s->cx, s->cy, s->cz);
+    kernels->project_stars(s->cx, s->cy, s->cz, m->vertex_count, view_width() / 2.0f, VIEW_HEIGHT / 2.0f,
+                           OBJECT_DISTANCE * 2.0f, s->px, s->py, s->size);
+
+    // Light from the upper left, in front of the object
+    const float lx = -0.4f, ly = -0.6f, lz = -0.7f;
+    const float light_len = sqrtf(lx * lx + ly * ly + lz * lz);
+    int faces = 0;
+    for (int t = 0; t < m->tri_count; t++) {
+        int a = m->tris[t][0], b = m->tris[t][1], c = m->tris[t][2];
+        if (s->cz[a] < NEAR_Z || s->cz[b] < NEAR_Z || s->cz[c] < NEAR_Z) continue;
+        float ux = s->cx[b] - s->cx[a], uy = s->cy[b] - s->cy[a], uz = s->cz[b] - s->cz[a];
+        float wx = s->cx[c] - s->cx[a], wy = s->cy[c] - s->cy[a], wz = s->cz[c] - s->cz[a];
+        float nx = uy * wz - uz * wy, ny = uz * wx - ux * wz, nz = ux * wy - uy * wx;
+        if (nx * s->cx[a] + ny * s->cy[a] + nz * s->cz[a] >= 0.0f) continue; // Facing away
+        float len = sqrtf(nx * nx + ny * ny + nz * nz);
+        float diffuse = len > 0.0f ? (nx * lx + ny * ly + nz * lz) / (len * light_len) : 0.0f;
+        s->faces[faces].depth = s->cz[a] + s->cz[b] + s->cz[c];
+        s->faces[faces].tri = t;
+        s->faces[faces].shade = AMBIENT + (1.0f - AMBIENT) * SDL_max(diffuse, 0.0f);
+        faces++;
+    }
+    qsort(s->faces, faces, sizeof(Face), farther_first);
+
+    SDL_Color edge_color = { (Uint8)((v->color.r + 255) / 2), (Uint8)((v->color.g + 255) / 2),
+                             (Uint8)((v->color.b + 255) / 2), 255 };
+    float fill_alpha = (1.0f - v->wire) * frame->alpha, edge_alpha = v->wire * frame->alpha;
+    for (int f = 0; f < faces; f++) {
+        const Uint16* tri = m->tris[s->faces[f].tri];
+        float shade = s->faces[f].shade;
+        if (fill_alpha > 0.0f) {
+            SDL_Color c = shaded(v->color, shade, fill_alpha);
+            for (int k = 0; k < 3; k++) push_vertex(s, s->px[tri[k]], s->py[tri[k]], c);
+        }
+        if (edge_alpha > 0.0f) {
+            SDL_Color c = shaded(edge_color, 0.5f + 0.5f * shade, edge_alpha);
+            Uint8 edges = m->edges[s->faces[f].tri];
+            for (int k = 0; k < 3; k++) {
+                if (edges & 1 << k) push_edge(s, tri[k], tri[k == 2 ? 0 : k + 1], c);
+            }
+        }
+    }
+}
+
+static void vector_render(Effect* fx, const EffectFrame* frame, SDL_Renderer* renderer) {
+    const VectorState* s = fx->state;
+    cmd_triangles(s->verts, s->vert_count, SDL_BLENDMODE_BLEND);
+}
+
+// The same list, in order, clipped to the tile
+static void vector_render_tile(Effect* fx, const EffectFrame* frame, const Tile* tile) {
+    const VectorState* s = fx->state;
+    float left = tile->x / tile->scale, right = (tile->x + tile->w) / tile->scale;
+    float top = tile->y / tile->scale, bottom = (tile->y + tile->h) / tile->scale;
+    for (int i = 0; i < s->vert_count; i += 3) {
+        const CmdVertex* v = &s->verts[i];
+        float x[3] = { v[0].x, v[1].x, v[2].x }, y[3] = { v[0].y, v[1].y, v[2].y };
+        if ((x[0] < left && x[1] < left && x[2] < left) || (x[0] > right && x[1] > right && x[2] > right) ||
+            (y[0] < top && y[1] < top && y[2] < top) || (y[0] > bottom && y[1] > bottom && y[2] > bottom)) continue;
+        tile_fill_triangle(tile, x, y, v->color);
+    }
+}
+
+static void vector_destroy(Effect* fx) {
+    VectorState* s = fx->state;
+    if (!s) return;
+    for (int i = 0; i < MESH_COUNT; i++) free(s->meshes[i]);
+    free(s->verts);
+    free(s);
+}
+
+Effect vector_effect = { "vector", vector_init, vector_update, vector_render, vector_destroy,
+                         NULL, vector_render_tile, vector_prepare };
@@ -0,0 +1,335 @@
+/*
+ * fx_voxel.c - Flight over a voxel landscape, drawn column by column.
+ *
+ * The landscape is a wrapping height map with a colour map to match,
+ * both generated at startup. Every screen column marches its own ray
+ * away from the camera, front to back, with steps that grow with the
+ * distance. A sample only draws the part of its column above everything
+ * drawn so far (the column's y-buffer), so nothing is ever overdrawn, and
+ * the march stops early once the column is full. What is left at the top
+ * is sky.
+ *
+ * Columns are independent, so prepare() hands them out in chunks on the
+ * job pool, into a buffer that the GPU path uploads and the CPU path
+ * stretches into its tiles. The cost grows with the view distance and the
+ * buffer's resolution, both of which are parameters.
+ */
+
+#include <SDL.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+#include "demo.h"
+#include "effect.h"
+#include "cmdbuf.h"
+#include "governor.h"
+#include "jobs.h"
+
+// --- Constants ---
+#define MAP_BITS 9
+#define MAP_SIZE (1 << MAP_BITS) // Cells along each side; the map wraps
+#define MAP_MASK (MAP_SIZE - 1)
+#define MAP_OFFSET (MAP_SIZE * 16.0f) // Keeps ray positions positive before the cast
+#define MAP_SEED 0x1b873593u
+#define SEA_LEVEL 80             // Heights below this are water
+#define HEIGHT_SCALE 0.5f        // Cells per height step
+#define CLEARANCE 60.0f          // Flight height over the terrain, height steps
+#define FOV_TAN 0.8f             // Tangent of half the horizontal field of view
+#define HORIZON 0.35f            // Horizon height, fraction of the screen from the top
+#define Z_GROWTH 0.012f          // Step growth per cell of distance
+#define FOG_START 0.4f           // Fraction of the view distance
+#define COLUMN_CHUNK 16          // Columns per job
+
+// --- Structs ---
+typedef struct {
+    float x, y;       // Camera position, cells
+    float angle;      // Heading, radians
+    float height;     // Height steps
+    float distance;   // View distance, cells
+    float resolution; // Share of the render size drawn
+    int detail;
+} VoxelView;
+
+typedef struct {
+    VoxelView view;
+    float time;
+    Uint8* heights;        // MAP_SIZE x MAP_SIZE, fixed after init
+    Uint32* colours;
+    // Main thread from here on
+    Uint32* pixels;        // w x h frame, row-major
+    Uint32* sky;           // One colour per row
+    int w, h;
+    TileLayer layer;       // GPU path
+} VoxelState;
+
+// One frame's rays, shared by the column jobs
+typedef struct {
+    const VoxelState* s;
+    float x, y, height;
+    float fx, fy, rx, ry;  // Forward and right, cells per cell of depth
+    float focal, horizon;  // Pixels
+    float distance, fog_start;
+    Uint32 fog;
+} VoxelFrame;
+
+
+static inline Uint32 next_random(Uint32* seed) {
+    *seed = *seed * 1664525u + 1013904223u;
+    return *seed >> 8;
+}
+
+static inline float random_offset(Uint32* seed, float amplitude) {
+    return ((float)next_random(seed) / 8388608.0f - 1.0f) * amplitude;
+}
+
+static inline float* cell(float* map, int x, int y) {
+    return &map[(y & MAP_MASK) * MAP_SIZE + (x & MAP_MASK)];
+}
+
+// Diamond-square on the wrapping grid
+static void build_heights(float* map) {
+    Uint32 seed = MAP_SEED;
+    float amplitude = 1.0f;
+    map[0] = 0.0f;
+    for (int step = MAP_SIZE; step > 1; step /= 2, amplitude *= 0.55f) {
+        int half = step / 2;
+        for (int y = 0; y < MAP_SIZE; y += step) {
+            for (int x = 0; x < MAP_SIZE; x += step) {
+                float sum = *cell(map, x, y) + *cell(map, x + step, y) + *cell(map, x, y + step) +
+                            *cell(map, x + step, y + step);
+                *cell(map, x + half, y + half) = sum * 0.25f + random_offset(&seed, amplitude);
+            }
+        }
+        for (int y = 0; y < MAP_SIZE; y += half) {
+            for (int x = (y / half & 1) ? 0 : half; x < MAP_SIZE; x += step) {
+                float sum = *cell(map, x - half, y) + *cell(map, x + half, y) + *cell(map, x, y - half) +
+                            *cell(map, x, y + half);
+                *cell(map, x, y) = sum * 0.25f + random_offset(&seed, amplitude);
+            }
+        }
+    }
+}
+
+// Water, sand, grass, rock and snow by height, lit from the west
+static Uint32 ground_colour(int h, int slope) {
+    int r, g, b;
+    if (h <= SEA_LEVEL) {
+        r = 20; g = 50; b = 120;
+    } else if (h < SEA_LEVEL + 8) {
+        r = 190; g = 170; b = 110;
+    } else if (h < 170) {
+        r = 40 + h / 4; g = 110 + h / 4; b = 30;
+    } else if (h < 215) {
+        r = 110; g = 100; b = 90;
+    } else {
+        r = 235; g = 235; b = 240;
+    }
+    int light = h <= SEA_LEVEL ? 256 : SDL_max(96, SDL_min(256 + slope * 6, 352));
+    r = SDL_min(255, r * light >> 8);
+    g = SDL_min(255, g * light >> 8);
+    b = SDL_min(255, b * light >> 8);
+    return 0xff000000 | (Uint32)r << 16 | (Uint32)g << 8 | (Uint32)b;
+}
+
+static int build_map(VoxelState* s) {
+    float* map = calloc(MAP_SIZE * MAP_SIZE, sizeof(float));
+    s->heights = malloc(MAP_SIZE * MAP_SIZE);
+    s->colours = malloc(sizeof(Uint32) * MAP_SIZE * MAP_SIZE);
+    if (!map || !s->heights || !s->colours) {
+        printf("Could not allocate the %dx%d voxel map\n", MAP_SIZE, MAP_SIZE);
+        free(map);
+        return 1;
+    }
+    build_heights(map);
+
+    float lo = map[0], hi = map[0];
+    for (int i = 0; i < MAP_SIZE * MAP_SIZE; i++) {
+        lo = SDL_min(lo, map[i]);
+        hi = SDL_max(hi, map[i]);
+    }
+    for (int i = 0; i < MAP_SIZE * MAP_SIZE; i++) {
+        int h = (int)((map[i] - lo) * 255.0f / SDL_max(hi - lo, 1e-6f));
+        s->heights[i] = (Uint8)SDL_max(h, SEA_LEVEL); // Flat water
+    }
+    for (int y = 0; y < MAP_SIZE; y++) {
+        for (int x = 0; x < MAP_SIZE; x++) {
+            int slope = s->heights[y * MAP_SIZE + ((x - 1) & MAP_MASK)] - s->heights[y * MAP_SIZE + ((x + 1) & MAP_MASK)];
+            s->colours[y * MAP_SIZE + x] = ground_colour(s->heights[y * MAP_SIZE + x], slope);
+        }
+    }
+    free(map);
+    return 0;
+}
+
+static int voxel_init(Effect* fx, SDL_Renderer* renderer) {
+    VoxelState* s = calloc(1, sizeof(VoxelState));
+    if (!s) return 1;
+    fx->state = s;
+    fx->view = &s->view;
+    fx->view_size = sizeof(VoxelView);
+    if (build_map(s) != 0) return 1;
+    s->view.height = s->heights[0] + CLEARANCE;
+    fx->table_bytes = (sizeof(Uint32) + 1) * MAP_SIZE * MAP_SIZE;
+    return 0;
+}
+
+static inline int height_at(const VoxelState* s, float x, float y) {
+    int i = ((int)(y + MAP_OFFSET) & MAP_MASK) * MAP_SIZE + ((int)(x + MAP_OFFSET) & MAP_MASK);
+    return s->heights[i];
+}
+
+// Fly forward on a slowly weaving heading, climbing ahead of the hills
+static void voxel_update(Effect* fx, float dt) {
+    VoxelState* s = fx->state;
+    VoxelView* v = &s->view;
+    s->time += dt;
+    v->angle = 0.6f * sinf(s->time * 0.11f) + 0.3f * sinf(s->time * 0.27f);
+    v->x = fmodf(v->x + cosf(v->angle) * fx->params[0] * dt + MAP_SIZE, MAP_SIZE);
+    v->y = fmodf(v->y + sinf(v->angle) * fx->params[0] * dt + MAP_SIZE, MAP_SIZE);
+
+    float ground = 0.0f;
+    for (int ahead = 0; ahead <= 60; ahead += 15) {
+        ground = SDL_max(ground, (float)height_at(s, v->x + cosf(v->angle) * ahead, v->y + sinf(v->angle) * ahead));
+    }
+    float target = ground + CLEARANCE;
+    v->height += (target - v->height) * SDL_min(1.0f, dt * (target > v->height ? 3.0f : 0.8f));
+
+    v->distance = SDL_max(fx->params[1], 16.0f);
+    v->resolution = SDL_max(0.1f, SDL_min(fx->params[2], 1.0f));
+    v->detail = current_quality()->detail;
+}
+
+static inline Uint32 fog_mix(Uint32 c, Uint32 fog, Uint32 a) {
+    Uint32 rb = (((fog & 0xff00ff) * a + (c & 0xff00ff) * (256 - a)) >> 8) & 0xff00ff;
+    Uint32 g = (((fog & 0x00ff00) * a + (c & 0x00ff00) * (256 - a)) >> 8) & 0x00ff00;
+    return 0xff000000 | rb | g;
+}
+
+// March COLUMN_CHUNK columns front to back; may run on any thread
+static void draw_columns(void* ctx, int index) {
+    const VoxelFrame* f = ctx;
+    const VoxelState* s = f->s;
+    int w = s->w, h = s->h;
+    int x1 = SDL_min(w, (index + 1) * COLUMN_CHUNK);
+    float fog_scale = 256.0f / SDL_max(f->distance - f->fog_start, 1.0f);
+    for (int x = index * COLUMN_CHUNK; x < x1; x++) {
+        float k = (2.0f * (x + 0.5f) / w - 1.0f) * FOV_TAN;
+        float dx = f->fx + f->rx * k, dy = f->fy + f->ry * k;
+        float px = f->x + MAP_OFFSET, py = f->y + MAP_OFFSET;
+        Uint32* column = s->pixels + x;
+        int top = h; // Rows from here down are drawn
+
+        float z = 1.0f, dz = 1.0f;
+        while (z < f->distance && top > 0) {
+            int i = ((int)(py + dy * z) & MAP_MASK) * MAP_SIZE + ((int)(px + dx * z) & MAP_MASK);
+            float sy = f->horizon + (f->height - s->heights[i]) * HEIGHT_SCALE * f->focal / z;
+            if (sy < top) {
+                int y0 = sy <= 0.0f ? 0 : (int)sy;
+                Uint32 c = s->colours[i];
+                if (z > f->fog_start) c = fog_mix(c, f->fog, (Uint32)((z - f->fog_start) * fog_scale));
+                for (int y = y0; y < top; y++) column[(size_t)y * w] = c;
+                top = y0;
+            }
+            z += dz;
+            dz += Z_GROWTH;
+        }
+        for (int y = 0; y < top; y++) column[(size_t)y * w] = s->sky[y];
+    }
+}
+
+static int size_frame(Effect* fx, int w, int h) {
+    VoxelState* s = fx->state;
+    w = SDL_max(w, 1);
+    h = SDL_max(h, 1);
+    if (w == s->w && h == s->h && s->pixels) return 0;
+    free(s->pixels);
+    free(s->sky);
+    s->pixels = malloc(sizeof(Uint32) * w * h);
+    s->sky = malloc(sizeof(Uint32) * h);
+    if (!s->pixels || !s->sky) {
+        printf("Could not allocate the %dx%d voxel frame\n", w, h);
+        free(s->pixels);
+        free(s->sky);
+        s->pixels = s->sky = NULL;
+        s->w = s->h = 0;
+        return 1;
+    }
+    s->w = w;
+    s->h = h;
+    fx->table_bytes = (sizeof(Uint32) + 1) * MAP_SIZE * MAP_SIZE + sizeof(Uint32) * ((size_t)w * h + h);
+    return 0;
+}
+
+// Deep blue overhead to a pale haze at the horizon, which is also the fog
+static Uint32 sky_colour(float t) {
+    t = SDL_max(0.0f, SDL_min(t, 1.0f));
+    Uint32 r = (Uint32)(30 + 170 * t), g = (Uint32)(60 + 150 * t), b = (Uint32)(140 + 90 * t);
+    return 0xff000000 | r << 16 | g << 8 | b;
+}
+
+// Render the frame on the job pool, at half resolution below full detail
+static void voxel_prepare(Effect* fx, const EffectFrame* frame) {
+    VoxelState* s = fx->state;
+    const VoxelView* v = frame->view;
+    int shift = v->detail >= 2 ? 0 : 1;
+    float scale = get_render_scale() * v->resolution;
+    if (size_frame(fx, (int)(screen_width() * scale) >> shift, (int)(screen_height() * scale) >> shift) != 0) return;
+
+    VoxelFrame f;
+    f.s = s;
+    f.x = v->x;
+    f.y = v->y;
+    f.height = v->height;
+    f.fx = cosf(v->angle);
+    f.fy = sinf(v->angle);
+    f.rx = -f.fy;
+    f.ry = f.fx;
+    f.focal = s->w * 0.5f / FOV_TAN;
+    f.horizon = s->h * HORIZON;
+    f.distance = v->distance;
+    f.fog_start = v->distance * FOG_START;
+    f.fog = sky_colour(1.0f);
+    for (int y = 0; y < s->h; y++) s->sky[y] = sky_colour(y / f.horizon);
+    run_jobs(draw_columns, &f, (s->w + COLUMN_CHUNK - 1) / COLUMN_CHUNK);
+}
+
+static void copy_band(void* ctx, const Tile* band) {
+    const VoxelState* s = ctx;
+    for (int y = band->y; y < band->y + band->h; y++) {
+        memcpy(band->fb + (size_t)y * band->pitch, s->pixels + (size_t)y * s->w, sizeof(Uint32) * s->w);
+    }
+}
+
+static void voxel_render(Effect* fx, const EffectFrame* frame, SDL_Renderer* renderer) {
+    VoxelState* s = fx->state;
+    if (!s->pixels) return;
+    if (draw_tile_layer(renderer, &s->layer, s->w, s->h, 1.0f, copy_band, s) != 0) return; // Scale unused
+
+    SDL_Color mod = { 255, 255, 255, (Uint8)(255 * frame->alpha) };
+    cmd_copy(s->layer.texture, NULL, NULL, mod, SDL_BLENDMODE_BLEND);
+}
+
+// The frame stretched over the screen, clipped to the tile
+static void voxel_render_tile(Effect* fx, const EffectFrame* frame, const Tile* tile) {
+    const VoxelState* s = fx->state;
+    if (!s->pixels) return;
+    TileImage image = { s->pixels, s->w, s->h };
+    SDL_Rect screen = { 0, 0, view_width(), VIEW_HEIGHT };
+    SDL_Color mod = { 255, 255, 255, (Uint8)(255 * frame->alpha) };
+    tile_blit(tile, &image, &screen, mod);
+}
+
+static void voxel_destroy(Effect* fx) {
+    VoxelState* s = fx->state;
+    if (!s) return;
+    free_tile_layer(&s->layer);
+    free(s->heights);
+    free(s->colours);
+    free(s->pixels);
+    free(s->sky);
+    free(s);
+}
+
+Effect voxel_effect = { "voxel", voxel_init, voxel_update, voxel_render, voxel_destroy,
+                        NULL, voxel_render_tile, voxel_prepare };
@@ -0,0 +1,124 @@
+/*
+ * governor.c - Adaptive quality governor.
+ *
+ * Frame times are averaged over short windows. The level drops after two
+ * windows in a row miss the budget, and rises only after a longer run of
+ * windows where the CPU work (everything but the present/vsync wait) used
+ * well under the budget. A level that had to be abandoned soon after
+ * stepping up to it needs twice as long before it is tried again, so a
+ * machine sitting on the edge settles instead of oscillating.
+ */
+
+#include <SDL.h>
+#include <stdio.h>
+#include "governor.h"
+
+// --- Constants ---
+#define GOVERNOR_WINDOW 30        // Frames per evaluation window
+#define GOVERNOR_OVER 1.15        // Window average above budget * this is a miss
+#define GOVERNOR_HEADROOM 0.55    // Busy time below budget * this counts as spare
+#define GOVERNOR_DOWN_WINDOWS 2
+#define GOVERNOR_UP_WINDOWS 4
+#define GOVERNOR_MAX_UP_WINDOWS 64
+
+// --- Quality Table ---
+static const Quality quality_levels[QUALITY_LEVELS] = {
+    // stars  particles  scale  detail
+    { 0.20f,  0.15f,     0.50f, 0 },
+    { 0.35f,  0.30f,     0.75f, 1 },
+    { 0.50f,  0.50f,     0.85f, 1 },
+    { 0.75f,  0.75f,     1.00f, 2 },
+    { 1.00f,  1.00f,     1.00f, 2 },
+};
+
+// --- Globals ---
+static SDL_atomic_t level;   // Read from any thread
+static int governor_enabled = 0;
+static double budget_ms = 1000.0 / 60.0;
+
+// Main thread only
+static int window_frames = 0;
+static double window_frame_sum = 0.0;
+static double window_busy_sum = 0.0;
+static int miss_windows = 0;
+static int spare_windows = 0;
+static int up_windows[QUALITY_LEVELS]; // Spare windows needed before stepping up into a level
+static int raised_at_window = -1;      // Window count when we last stepped up
+static int window_index = 0;
+
+
+int init_governor(int enabled, int start_level, float target_fps) {
+    if (start_level < 0 || start_level >= QUALITY_LEVELS) {
+        printf("Quality level must be between 0 and %d\n", QUALITY_LEVELS - 1);
+        return 1;
+    }
+    governor_enabled = enabled;
+    if (target_fps > 0.0f) budget_ms = 1000.0 / target_fps;
+    for (int i = 0; i < QUALITY_LEVELS; i++) up_windows[i] = GOVERNOR_UP_WINDOWS;
+    SDL_AtomicSet(&level, start_level);
+    return 0;
+}
+
+static void set_level(int next, double frame_ms, double busy_ms) {
+    int prev = SDL_AtomicGet(&level);
+    const Quality* q = &quality_levels[next];
+
+    SDL_AtomicSet(&level, next);
+    printf("Governor: quality %d -> %d (frame %.2f ms, busy %.2f ms, budget %.2f ms): "
+           "stars %d%%, particles %d%%, scale %d%%, detail %d\n",
+           prev, next, frame_ms, busy_ms, budget_ms,
+           (int)(q->star_fraction * 100), (int)(q->particle_fraction * 100),
+           (int)(q->render_scale * 100), q->detail);
+    miss_windows = 0;
+    spare_windows = 0;
+}
+
+// Feed one frame: total frame time and the part spent before presenting
+void update_governor(double frame_ms, double busy_ms) {
+    if (!governor_enabled) return;
+
+    window_frame_sum += frame_ms;
+    window_busy_sum += busy_ms;
+    if (++window_frames < GOVERNOR_WINDOW) return;
+
+    double avg_frame = window_frame_sum / window_frames;
+    double avg_busy = window_busy_sum / window_frames;
+    window_frames = 0;
+    window_frame_sum = 0.0;
+    window_busy_sum = 0.0;
+    window_index++;
+
+    int current = SDL_AtomicGet(&level);
+
+    if (avg_frame > budget_ms * GOVERNOR_OVER) {
+        spare_windows = 0;
+        if (++miss_windows >= GOVERNOR_DOWN_WINDOWS && current > 0) {
+            // Gave up on a level we only just reached: make it harder to return
+            if (raised_at_window >= 0 && window_index - raised_at_window <= GOVERNOR_UP_WINDOWS * 2) {
+                int* need = &up_windows[current];
+                *need = *need * 2 > GOVERNOR_MAX_UP_WINDOWS ? GOVERNOR_MAX_UP_WINDOWS : *need * 2;
+            }
+            raised_at_window = -1;
+            set_level(current - 1, avg_frame, avg_busy);
+        }
+        return;
+    }
+
+    miss_windows = 0;
+    if (avg_busy < budget_ms * GOVERNOR_HEADROOM) {
+        if (current + 1 < QUALITY_LEVELS && ++spare_windows >= up_windows[current + 1]) {
+            raised_at_window = window_index;
+            set_level(current + 1, avg_frame, avg_busy);
+        }
+    } else {
+        spare_windows = 0;
+    }
+}
+
+const Quality* current_quality() {
+    return &quality_levels[SDL_AtomicGet(&level)];
+}
+
+int current_quality_level() {
+    return SDL_AtomicGet(&level);
+}
@@ -0,0 +1,26 @@
+/*
+ * governor.h - Adaptive quality governor.
+ *
+ * Watches frame times and steps through a table of quality levels to keep
+ * the frame inside its budget. Effects read the current level through
+ * current_quality() from any thread.
+ */
+
+#ifndef GOVERNOR_H
+#define GOVERNOR_H
+
+#define QUALITY_LEVELS 5
+
+typedef struct {
+    float star_fraction;     // Share of the starfield simulated and drawn
+    float particle_fraction; // Share of each particle effect's budget
+    float render_scale;      // Internal resolution relative to the window
+    int detail;              // Effect detail, 0 (lowest) to 2
+} Quality;
+
+int init_governor(int enabled, int start_level, float target_fps);
+void update_governor(double frame_ms, double busy_ms);
+const Quality* current_quality();
+int current_quality_level();
+
+#endif
@@ -0,0 +1,136 @@
+/*
+ * jobs.c - Worker thread pool.
+ *
+ * Workers sleep on a condition variable between batches. A batch is
+ * started by bumping the generation counter; indices are claimed with an
+ * atomic add, and the last worker to run dry wakes the caller.
+ */
+
+#include <SDL.h>
+#include <stdio.h>
+#include "jobs.h"
+
+// --- Constants ---
+#define MAX_WORKERS 63
+
+// --- Globals ---
+static SDL_Thread* workers[MAX_WORKERS];
+static int worker_count = 0;
+static SDL_mutex* lock = NULL;
+static SDL_cond* start_cond = NULL;
+static SDL_cond* done_cond = NULL;
+
+// Current batch, written under the lock before the generation changes
+static JobFunc job_fn = NULL;
+static void* job_ctx = NULL;
+static int job_count = 0;
+static SDL_atomic_t next_index;
+static int busy_workers = 0;
+static unsigned generation = 0;
+static int quitting = 0;
+
+
+// Run jobs until the batch has none left
+static void drain_jobs() {
+    for (;;) {
+        int i = SDL_AtomicAdd(&next_index, 1);
+        if (i >= job_count) break;
+        job_fn(job_ctx, i);
+    }
+}
+
+static int worker_main(void* data) {
+    unsigned seen = 0;
+    for (;;) {
+        SDL_LockMutex(lock);
+        while (!quitting && generation == seen) {
+            SDL_CondWait(start_cond, lock);
+        }
+        if (quitting) {
+            SDL_UnlockMutex(lock);
+            return 0;
+        }
+        seen = generation;
+        SDL_UnlockMutex(lock);
+
+        drain_jobs();
+
+        SDL_LockMutex(lock);
+        if (--busy_workers == 0) SDL_CondSignal(done_cond);
+        SDL_UnlockMutex(lock);
+    }
+}
+
+int init_jobs(int threads) {
+    if (threads <= 0) threads = SDL_GetCPUCount();
+    if (threads > MAX_WORKERS + 1) threads = MAX_WORKERS + 1;
+
+    lock = SDL_CreateMutex();
+    start_cond = SDL_CreateCond();
+    done_cond = SDL_CreateCond();
+    if (!lock || !start_cond || !done_cond) {
+        printf("Could not create job pool locks! SDL_Error: %s\n", SDL_GetError());
+        return 1;
+    }
+
+    // The caller works too, so it counts as one of the threads
+    for (int i = 0; i < threads - 1; i++) {
+        workers[i] = SDL_CreateThread(worker_main, "jobs", NULL);
+        if (!workers[i]) {
+            printf("Could not start job worker, continuing with %d! SDL_Error: %s\n",
+                   worker_count, SDL_GetError());
+            break;
+        }
+        worker_count++;
+    }
+    return 0;
+}
+
+void run_jobs(JobFunc fn, void* ctx, int count) {
+    if (count <= 0) return;
+    if (worker_count == 0 || count == 1) {
+        for (int i = 0; i < count; i++) fn(ctx, i);
+        return;
+    }
+
+    SDL_LockMutex(lock);
+    job_fn = fn;
+    job_ctx = ctx;
+    job_count = count;
+    SDL_AtomicSet(&next_index, 0);
+    busy_workers = worker_count;
+    generation++;
+    SDL_CondBroadcast(start_cond);
+    SDL_UnlockMutex(lock);
+
+    drain_jobs();
+
+    SDL_LockMutex(lock);
+    while (busy_workers > 0) {
+        SDL_CondWait(done_cond, lock);
+    }
+    SDL_UnlockMutex(lock);
+}
+
+int job_thread_count() {
+    return worker_count + 1;
+}
+
+void cleanup_jobs() {
+    if (lock) {
+        SDL_LockMutex(lock);
+        quitting = 1;
+        SDL_CondBroadcast(start_cond);
+        SDL_UnlockMutex(lock);
+    }
+    for (int i = 0; i < worker_count; i++) {
+        SDL_WaitThread(workers[i], NULL);
+    }
+    worker_count = 0;
+    quitting = 0;
+    if (done_cond) SDL_DestroyCond(done_cond);
+    if (start_cond) SDL_DestroyCond(start_cond);
+    if (lock) SDL_DestroyMutex(lock);
+    done_cond = start_cond = NULL;
+    lock = NULL;
+}
@@ -0,0 +1,20 @@
+/*
+ * jobs.h - Small worker thread pool for data-parallel work.
+ *
+ * run_jobs() calls fn(ctx, i) for every i in [0, count) spread over the
+ * workers and the calling thread, and returns once all calls finished.
+ * Jobs are handed out one index at a time, so uneven jobs balance out.
+ * Only one thread may call run_jobs() at a time.
+ */
+
+#ifndef JOBS_H
+#define JOBS_H
+
+typedef void (*JobFunc)(void* ctx, int index);
+
+int init_jobs(int threads); // Total threads including the caller; 0 = one per CPU
+void run_jobs(JobFunc fn, void* ctx, int count);
+int job_thread_count();
+void cleanup_jobs();
+
+#endif
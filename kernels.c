@@ -0,0 +1,228 @@
+/*
+ * kernels.c - Scalar reference kernels and runtime dispatch.
+ *
+ * The scalar set defines the exact arithmetic; the vector sets in
+ * kernels_*.c repeat it lane by lane.
+ */
+
+#include <SDL.h>
+#include <stdio.h>
+#include "kernels.h"
+
+#if defined(__x86_64__) || defined(__i386__)
+#define KERNELS_X86 1
+extern const Kernels kernels_sse2;
+extern const Kernels kernels_avx2;
+extern const Kernels kernels_avx512;
+#else
+#define KERNELS_X86 0
+// One portable 128-bit set (NEON on arm64), built with the default flags
+#define KERNEL_VEC_BYTES 16
+#define KERNEL_SET vec128
+#define KERNEL_NAME "vec128"
+#include "kernels_impl.h"
+#endif
+
+
+static inline Uint32 blend_pixel(Uint32 dst, Uint32 src, Uint32 a) {
+    Uint32 rb = (((src & 0xff00ff) * a + (dst & 0xff00ff) * (256 - a)) >> 8) & 0xff00ff;
+    Uint32 g = (((src & 0x00ff00) * a + (dst & 0x00ff00) * (256 - a)) >> 8) & 0x00ff00;
+    return 0xff000000 | rb | g;
+}
+
+static void fill_span_scalar(Uint32* dst, int count, Uint32 argb) {
+    for (int i = 0; i < count; i++) dst[i] = argb;
+}
+
+static void blend_span_scalar(Uint32* dst, int count, Uint32 argb, Uint32 alpha) {
+    for (int i = 0; i < count; i++) dst[i] = blend_pixel(dst[i], argb, alpha);
+}
+
+static void blend_row_scalar(Uint32* dst, const Uint32* src, int count,
+                             Uint32 mod_r, Uint32 mod_g, Uint32 mod_b, Uint32 mod_a) {
+    for (int i = 0; i < count; i++) {
+        Uint32 s = src[i];
+        Uint32 a = ((s >> 24) * mod_a) >> 8;
+        if (a == 0) continue;
+        a += a >> 7;
+        Uint32 c = ((((s >> 16) & 0xff) * mod_r >> 8) << 16) |
+                   ((((s >> 8) & 0xff) * mod_g >> 8) << 8) |
+                   ((s & 0xff) * mod_b >> 8);
+        dst[i] = blend_pixel(dst[i], c, a);
+    }
+}
+
+static void plasma_span_scalar(Uint32* dst, const Uint8* col, const Uint8* diag, Uint8 row,
+                               const Uint32* palette, int count) {
+    for (int i = 0; i < count; i++) dst[i] = palette[(Uint8)(col[i] + diag[i] + row)];
+}
+
+static inline Uint32 texel_index(Uint32 uv, Uint32 offset) {
+    return ((uv + offset) & 0x00ff) | ((uv + (offset & 0xff00)) & 0xff00);
+}
+
+static void tunnel_span_scalar(Uint32* dst, const Uint16* uv, const Uint8* shade, Uint32 offset,
+                               Uint32 level, const Uint32* texture, int count) {
+    for (int i = 0; i < count; i++) {
+        Uint32 t = texture[texel_index(uv[i], offset)];
+        Uint32 s = shade[i] * level >> 8;
+        dst[i] = 0xff000000 | (((t & 0xff00ff) * s >> 8) & 0xff00ff) | (((t & 0x00ff00) * s >> 8) & 0x00ff00);
+    }
+}
+
+static void rotozoom_span_scalar(Uint32* dst, Uint32 u, Uint32 v, Uint32 du, Uint32 dv,
+                                 Uint32 level, const Uint32* texture, int count) {
+    for (int i = 0; i < count; i++) {
+        Uint32 t = texture[(v >> 8 & 0xff00) | (u >> 16 & 0xff)];
+        dst[i] = 0xff000000 | (((t & 0xff00ff) * level >> 8) & 0xff00ff) | (((t & 0x00ff00) * level >> 8) & 0x00ff00);
+        u += du;
+        v += dv;
+    }
+}
+
+static void fire_row_scalar(Uint8* dst, const Uint8* below, const Uint8* below2, int count, Uint32 cool) {
+    for (int i = 0; i < count; i++) {
+        Uint32 sum = below[i - 1] + below[i] + below[i + 1] + below2[i];
+        dst[i] = (Uint8)(sum > cool ? (sum - cool) >> 2 : 0);
+    }
+}
+
+static inline Uint32 add_pixel(Uint32 dst, Uint32 src) {
+    // Carries out of a channel become an all-ones mask for that channel
+    Uint32 rb = (dst & 0xff00ff) + (src & 0xff00ff);
+    Uint32 g = (dst & 0x00ff00) + (src & 0x00ff00);
+    rb |= (rb & 0x01000100) - ((rb & 0x01000100) >> 8);
+    g |= (g & 0x00010000) - ((g & 0x00010000) >> 8);
+    return 0xff000000 | (rb & 0xff00ff) | (g & 0x00ff00);
+}
+
+static void heat_span_scalar(Uint32* dst, const Uint8* heat, Uint32 u, Uint32 du, const Uint32* palette, int count) {
+    for (int i = 0; i < count; i++, u += du) dst[i] = add_pixel(dst[i], palette[heat[u >> 16]]);
+}
+
+static void metaball_span_scalar(Uint32* dst, float x, float y, const float* bx, const float* by,
+                                 const float* inv_r2, int blobs, const Uint32* palette, int count) {
+    for (int i = 0; i < count; i++) {
+        float px = x + (float)i, field = 0.0f;
+        for (int b = 0; b < blobs; b++) {
+            float dx = px - bx[b], dy = y - by[b];
+            float t = 1.0f - (dx * dx + dy * dy) * inv_r2[b];
+            t = t > 0.0f ? t : 0.0f;
+            field += t * t;
+        }
+        float index = field * 128.0f;
+        dst[i] = add_pixel(dst[i], palette[index < 255.0f ? (int)index : 255]);
+    }
+}
+
+static void advance_stars_scalar(float* z, const float* speed, int count, float step) {
+    for (int i = 0; i < count; i++) z[i] -= speed[i] * step;
+}
+
+static void project_stars_scalar(const float* x, const float* y, const float* z, int count,
+                                 float cx, float cy, float spread, float* px, float* py, float* size) {
+    for (int i = 0; i < count; i++) {
+        float k = 128.0f / z[i];
+        px[i] = x[i] * k + cx;
+        py[i] = y[i] * k + cy;
+        size[i] = (1.0f - z[i] / spread) * 3.0f;
+    }
+}
+
+static void advance_particles_scalar(float* x, float* y, float* vx, float* vy, float* life, int count,
+                                     float dt, float gravity, float drag) {
+    float fall = gravity * dt;
+    for (int i = 0; i < count; i++) {
+        x[i] += vx[i] * dt;
+        y[i] += vy[i] * dt;
+        vx[i] = vx[i] * drag;
+        vy[i] = vy[i] * drag + fall;
+        life[i] -= dt;
+    }
+}
+
+static void transform_points_scalar(const float* x, const float* y, const float* z, int count, const float* m,
+                                    float* out_x, float* out_y, float* out_z) {
+    for (int i = 0; i < count; i++) {
+        out_x[i] = m[0] * x[i] + m[1] * y[i] + m[2] * z[i] + m[3];
+        out_y[i] = m[4] * x[i] + m[5] * y[i] + m[6] * z[i] + m[7];
+        out_z[i] = m[8] * x[i] + m[9] * y[i] + m[10] * z[i] + m[11];
+    }
+}
+
+static const Kernels kernels_scalar = {
+    "scalar",
+    fill_span_scalar,
+    blend_span_scalar,
+    blend_row_scalar,
+    plasma_span_scalar,
+    tunnel_span_scalar,
+    rotozoom_span_scalar,
+    fire_row_scalar,
+    heat_span_scalar,
+    metaball_span_scalar,
+    advance_stars_scalar,
+    project_stars_scalar,
+    advance_particles_scalar,
+    transform_points_scalar,
+};
+
+const Kernels* kernels = &kernels_scalar;
+
+// Every set this binary has, widest first, and whether the CPU runs it
+typedef struct {
+    const Kernels* set;
+    int supported;
+} KernelChoice;
+
+static int get_choices(KernelChoice* out) {
+    int n = 0;
+#if KERNELS_X86
+#if SDL_VERSION_ATLEAST(2, 0, 9)
+    out[n++] = (KernelChoice){ &kernels_avx512, SDL_HasAVX512F() };
+#endif
+    out[n++] = (KernelChoice){ &kernels_avx2, SDL_HasAVX2() };
+    out[n++] = (KernelChoice){ &kernels_sse2, SDL_HasSSE2() };
+#else
+    out[n++] = (KernelChoice){ &kernels_vec128, 1 };
+#endif
+    out[n++] = (KernelChoice){ &kernels_scalar, 1 };
+    return n;
+}
+
+void list_kernels() {
+    KernelChoice choices[5];
+    int n = get_choices(choices);
+    printf("Kernel sets:\n");
+    for (int i = 0; i < n; i++) {
+        printf("  %-8s%s\n", choices[i].set->name, choices[i].supported ? "" : " (not supported by this CPU)");
+    }
+}
+
+const Kernels* find_kernels(const char* name) {
+    KernelChoice choices[5];
+    int n = get_choices(choices);
+    for (int i = 0; i < n; i++) {
+        if (choices[i].supported && SDL_strcasecmp(name, choices[i].set->name) == 0) return choices[i].set;
+    }
+    return NULL;
+}
+
+// Must run before any thread uses the kernels
+int init_kernels(const char* force) {
+    KernelChoice choices[5];
+    int n = get_choices(choices);
+    for (int i = 0; i < n; i++) {
+        if (force && SDL_strcasecmp(force, choices[i].set->name) != 0) continue;
+        if (!choices[i].supported) {
+            if (!force) continue;
+            printf("This CPU does not support the %s kernels.\n", force);
+            return 1;
+        }
+        kernels = choices[i].set;
+        return 0;
+    }
+    printf("Unknown kernel set '%s'.\n", force);
+    list_kernels();
+    return 1;
+}
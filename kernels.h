@@ -0,0 +1,73 @@
+/*
+ * kernels.h - Per-pixel and per-star inner loops with runtime ISA dispatch.
+ *
+ * Each kernel is built several times: a plain scalar reference, and
+ * vector versions for SSE2, AVX2 and AVX-512 on x86 (one 128-bit version
+ * elsewhere). init_kernels() asks SDL's CPUID checks which ones this
+ * machine runs and points `kernels` at the widest. Every variant gives
+ * bit-identical results to the scalar one, so the choice never changes
+ * the picture.
+ *
+ * Pixels are opaque ARGB8888 and alphas are 0..256 (see tiles.c).
+ */
+
+#ifndef KERNELS_H
+#define KERNELS_H
+
+#include <SDL.h>
+
+typedef struct {
+    const char* name;
+
+    // Pixel spans
+    void (*fill_span)(Uint32* dst, int count, Uint32 argb);
+    void (*blend_span)(Uint32* dst, int count, Uint32 argb, Uint32 alpha);
+    // Source-over of `src` with straight alpha after colour/alpha modulation
+    void (*blend_row)(Uint32* dst, const Uint32* src, int count,
+                      Uint32 mod_r, Uint32 mod_g, Uint32 mod_b, Uint32 mod_a);
+
+    // Palette index col[i] + diag[i] + row, computed bytewise, mapped through palette
+    void (*plasma_span)(Uint32* dst, const Uint8* col, const Uint8* diag, Uint8 row,
+                        const Uint32* palette, int count);
+    // Texel of a 256x256 texture at uv + offset, each byte wrapping on its
+    // own (u low, v high), then darkened by shade * level (level 0..256)
+    void (*tunnel_span)(Uint32* dst, const Uint16* uv, const Uint8* shade, Uint32 offset,
+                        Uint32 level, const Uint32* texture, int count);
+    // Texels of a 256x256 texture along a line: u, v are 16.16 texel
+    // coordinates that wrap, stepped by du, dv per pixel; scaled by level
+    void (*rotozoom_span)(Uint32* dst, Uint32 u, Uint32 v, Uint32 du, Uint32 dv,
+                          Uint32 level, const Uint32* texture, int count);
+    // One fire row: (below[i-1] + below[i] + below[i+1] + below2[i] - cool) / 4,
+    // clamped at 0; reads below[-1] and below[count]
+    void (*fire_row)(Uint8* dst, const Uint8* below, const Uint8* below2, int count, Uint32 cool);
+    // Adds palette[heat[u >> 16]] to dst with per-channel saturation, u
+    // stepped by du per pixel (16.16)
+    void (*heat_span)(Uint32* dst, const Uint8* heat, Uint32 u, Uint32 du, const Uint32* palette, int count);
+    // Metaball field at pixel centres (x + i, y): the sum over the blobs of
+    // max(0, 1 - d^2 * inv_r2)^2, with field 1 at palette index 128,
+    // clamped at 255. The colour is added to dst like heat_span's
+    void (*metaball_span)(Uint32* dst, float x, float y, const float* bx, const float* by,
+                          const float* inv_r2, int blobs, const Uint32* palette, int count);
+
+    // Stars, structure of arrays
+    void (*advance_stars)(float* z, const float* speed, int count, float step);
+    void (*project_stars)(const float* x, const float* y, const float* z, int count,
+                          float cx, float cy, float spread, float* px, float* py, float* size);
+
+    // Particles, structure of arrays: one Euler step with gravity and drag
+    void (*advance_particles)(float* x, float* y, float* vx, float* vy, float* life, int count,
+                              float dt, float gravity, float drag);
+
+    // Vertices, structure of arrays: out = m * (x, y, z, 1), m being a 3x4
+    // row-major matrix (rotation in the first three columns, then translation)
+    void (*transform_points)(const float* x, const float* y, const float* z, int count, const float* m,
+                             float* out_x, float* out_y, float* out_z);
+} Kernels;
+
+extern const Kernels* kernels;
+
+int init_kernels(const char* force); // NULL picks the best supported set
+const Kernels* find_kernels(const char* name); // NULL if absent or unsupported
+void list_kernels();
+
+#endif
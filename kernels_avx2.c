@@ -0,0 +1,25 @@
+/*
+ * kernels_avx2.c - 32-byte vector kernels built for AVX2.
+ */
+
+#include <SDL.h>
+#include "kernels.h"
+
+#if defined(__x86_64__) || defined(__i386__)
+
+#if defined(__clang__)
+#pragma clang attribute push (__attribute__((target("avx2"))), apply_to = function)
+#else
+#pragma GCC target("avx2")
+#endif
+
+#define KERNEL_VEC_BYTES 32
+#define KERNEL_SET avx2
+#define KERNEL_NAME "avx2"
+#include "kernels_impl.h"
+
+#if defined(__clang__)
+#pragma clang attribute pop
+#endif
+
+#endif
@@ -0,0 +1,25 @@
+/*
+ * kernels_avx512.c - 64-byte vector kernels built for AVX-512.
+ */
+
+#include <SDL.h>
+#include "kernels.h"
+
+#if defined(__x86_64__) || defined(__i386__)
+
+#if defined(__clang__)
+#pragma clang attribute push (__attribute__((target("avx512f"))), apply_to = function)
+#else
+#pragma GCC target("avx512f")
+#endif
+
+#define KERNEL_VEC_BYTES 64
+#define KERNEL_SET avx512
+#define KERNEL_NAME "avx512"
+#include "kernels_impl.h"
+
+#if defined(__clang__)
+#pragma clang attribute pop
+#endif
+
+#endif
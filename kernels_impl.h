@@ -0,0 +1,360 @@
+/*
+ * kernels_impl.h - Vector kernel bodies, included once per instruction set.
+ *
+ * The including file selects the target ISA and defines KERNEL_VEC_BYTES
+ * (vector width) and KERNEL_SET (name suffix); GCC vector extensions then
+ * compile to that width. Tails fall back to the scalar formulas, and no
+ * floating-point contraction is allowed, so every width matches the
+ * scalar kernels in kernels.c exactly.
+ */
+
+#if defined(__clang__)
+#pragma clang fp contract(off)
+#else
+#pragma GCC optimize("fp-contract=off")
+#endif
+
+#include <string.h>
+
+#define KERNEL_LANES (KERNEL_VEC_BYTES / 4)
+#define KERNEL_CAT2(a, b) a##_##b
+#define KERNEL_CAT(a, b) KERNEL_CAT2(a, b)
+#define KERNEL_FN(name) KERNEL_CAT(name, KERNEL_SET)
+
+typedef Uint32 vu32 __attribute__((vector_size(KERNEL_VEC_BYTES)));
+typedef float vf32 __attribute__((vector_size(KERNEL_VEC_BYTES)));
+typedef Uint8 vu8 __attribute__((vector_size(KERNEL_VEC_BYTES)));
+typedef Sint32 vs32 __attribute__((vector_size(KERNEL_VEC_BYTES)));
+// 16-bit lanes; AVX-512F has no 16-bit operations, so these stop at 32 bytes
+#define KERNEL_VEC16_BYTES (KERNEL_VEC_BYTES > 32 ? 32 : KERNEL_VEC_BYTES)
+typedef Uint16 vu16 __attribute__((vector_size(KERNEL_VEC16_BYTES)));
+typedef Uint8 vu8_half __attribute__((vector_size(KERNEL_VEC16_BYTES / 2))); // Bytes widened to vu16
+
+// Unaligned loads and stores; these compile to single vector moves
+static inline vu32 load_u32(const Uint32* p) { vu32 v; memcpy(&v, p, sizeof(v)); return v; }
+static inline void store_u32(Uint32* p, vu32 v) { memcpy(p, &v, sizeof(v)); }
+static inline vu8 load_u8(const Uint8* p) { vu8 v; memcpy(&v, p, sizeof(v)); return v; }
+static inline vu16 load_u8_wide(const Uint8* p) {
+    vu8_half v;
+    memcpy(&v, p, sizeof(v));
+    return __builtin_convertvector(v, vu16);
+}
+static inline void store_u8_narrow(Uint8* p, vu16 v) {
+    vu8_half n = __builtin_convertvector(v, vu8_half);
+    memcpy(p, &n, sizeof(n));
+}
+// One element per 32-bit lane, widened
+typedef Uint16 vu16_lanes __attribute__((vector_size(KERNEL_LANES * 2)));
+typedef Uint8 vu8_lanes __attribute__((vector_size(KERNEL_LANES)));
+static inline vu32 load_u16_lanes(const Uint16* p) {
+    vu16_lanes v;
+    memcpy(&v, p, sizeof(v));
+    return __builtin_convertvector(v, vu32);
+}
+static inline vu32 load_u8_lanes(const Uint8* p) {
+    vu8_lanes v;
+    memcpy(&v, p, sizeof(v));
+    return __builtin_convertvector(v, vu32);
+}
+static inline vf32 load_f32(const float* p) { vf32 v; memcpy(&v, p, sizeof(v)); return v; }
+static inline void store_f32(float* p, vf32 v) { memcpy(p, &v, sizeof(v)); }
+
+static inline Uint32 blend_one(Uint32 dst, Uint32 src, Uint32 a) {
+    Uint32 rb = (((src & 0xff00ff) * a + (dst & 0xff00ff) * (256 - a)) >> 8) & 0xff00ff;
+    Uint32 g = (((src & 0x00ff00) * a + (dst & 0x00ff00) * (256 - a)) >> 8) & 0x00ff00;
+    return 0xff000000 | rb | g;
+}
+
+static inline Uint32 add_one(Uint32 dst, Uint32 src) {
+    Uint32 rb = (dst & 0xff00ff) + (src & 0xff00ff);
+    Uint32 g = (dst & 0x00ff00) + (src & 0x00ff00);
+    rb |= (rb & 0x01000100) - ((rb & 0x01000100) >> 8);
+    g |= (g & 0x00010000) - ((g & 0x00010000) >> 8);
+    return 0xff000000 | (rb & 0xff00ff) | (g & 0x00ff00);
+}
+
+static inline vu32 blend_vec(vu32 dst, vu32 src, vu32 a) {
+    vu32 inv = 256 - a;
+    vu32 rb = (((src & 0xff00ff) * a + (dst & 0xff00ff) * inv) >> 8) & 0xff00ff;
+    vu32 g = (((src & 0x00ff00) * a + (dst & 0x00ff00) * inv) >> 8) & 0x00ff00;
+    return 0xff000000 | rb | g;
+}
+
+static void KERNEL_FN(fill_span)(Uint32* dst, int count, Uint32 argb) {
+    vu32 v = (vu32){ 0 } + argb;
+    int i = 0;
+    for (; i + KERNEL_LANES <= count; i += KERNEL_LANES) store_u32(dst + i, v);
+    for (; i < count; i++) dst[i] = argb;
+}
+
+static void KERNEL_FN(blend_span)(Uint32* dst, int count, Uint32 argb, Uint32 alpha) {
+    vu32 src = (vu32){ 0 } + argb;
+    vu32 a = (vu32){ 0 } + alpha;
+    int i = 0;
+    for (; i + KERNEL_LANES <= count; i += KERNEL_LANES) {
+        store_u32(dst + i, blend_vec(load_u32(dst + i), src, a));
+    }
+    for (; i < count; i++) dst[i] = blend_one(dst[i], argb, alpha);
+}
+
+static void KERNEL_FN(blend_row)(Uint32* dst, const Uint32* src, int count,
+                                 Uint32 mod_r, Uint32 mod_g, Uint32 mod_b, Uint32 mod_a) {
+    int i = 0;
+    for (; i + KERNEL_LANES <= count; i += KERNEL_LANES) {
+        vu32 s = load_u32(src + i);
+        vu32 a = ((s >> 24) * mod_a) >> 8;
+        a += a >> 7;
+        vu32 c = (((((s >> 16) & 0xff) * mod_r) >> 8) << 16) |
+                 (((((s >> 8) & 0xff) * mod_g) >> 8) << 8) |
+                 (((s & 0xff) * mod_b) >> 8);
+        store_u32(dst + i, blend_vec(load_u32(dst + i), c, a)); // Alpha 0 leaves dst as is
+    }
+    for (; i < count; i++) {
+        Uint32 s = src[i];
+        Uint32 a = ((s >> 24) * mod_a) >> 8;
+        a += a >> 7;
+        Uint32 c = ((((s >> 16) & 0xff) * mod_r >> 8) << 16) |
+                   ((((s >> 8) & 0xff) * mod_g >> 8) << 8) |
+                   ((s & 0xff) * mod_b >> 8);
+        dst[i] = blend_one(dst[i], c, a);
+    }
+}
+
+// Left as the plain loop in every set. Each pixel is one palette load and
+// one store, and those bound it: summing the indices a vector at a time
+// and then storing the colours as vectors was no faster over a whole
+// 1080p frame (scroller_bench plasma_1080p), and slower with SSE2 and
+// AVX-512
+static void KERNEL_FN(plasma_span)(Uint32* dst, const Uint8* col, const Uint8* diag, Uint8 row,
+                                   const Uint32* palette, int count) {
+    for (int i = 0; i < count; i++) dst[i] = palette[(Uint8)(col[i] + diag[i] + row)];
+}
+
+static inline Uint32 texel_index_one(Uint32 uv, Uint32 offset) {
+    return ((uv + offset) & 0x00ff) | ((uv + (offset & 0xff00)) & 0xff00);
+}
+
+// Every byte of c times k (0..256) >> 8, with the alpha byte cleared. The
+// bytes sit in 16-bit lanes, where there is a cheap multiply; SSE2 has no
+// 32-bit one at all. AVX-512F has no 16-bit operations and uses its
+// 32-bit multiply instead
+#if KERNEL_VEC_BYTES <= 32
+typedef Uint16 vu16_full __attribute__((vector_size(KERNEL_VEC_BYTES)));
+static inline vu32 scale_bytes(vu32 c, vu32 k) {
+    vu16_full k16 = (vu16_full)(k | k << 16);
+    vu32 rb = (vu32)((vu16_full)(c & 0xff00ff) * k16 >> 8);
+    vu32 g = (vu32)((vu16_full)((c >> 8) & 0xff) * k16 >> 8);
+    return rb | g << 8;
+}
+#else
+static inline vu32 scale_bytes(vu32 c, vu32 k) {
+    return (((c & 0xff00ff) * k >> 8) & 0xff00ff) | (((c & 0x00ff00) * k >> 8) & 0x00ff00);
+}
+#endif
+
+// Indices and shading a whole vector at a time. The texel fetch is a
+// gather: plain scalar loads into an aligned block that is then loaded
+// as one vector, since writing vector lanes one by one compiles to
+// inserts and spills that cost more than the scalar loop
+static void KERNEL_FN(tunnel_span)(Uint32* dst, const Uint16* uv, const Uint8* shade, Uint32 offset,
+                                   Uint32 level, const Uint32* texture, int count) {
+    Uint32 index[KERNEL_LANES] __attribute__((aligned(KERNEL_VEC_BYTES)));
+    Uint32 texel[KERNEL_LANES] __attribute__((aligned(KERNEL_VEC_BYTES)));
+    int i = 0;
+    for (; i + KERNEL_LANES <= count; i += KERNEL_LANES) {
+        vu32 c = load_u16_lanes(uv + i);
+        store_u32(index, ((c + offset) & 0x00ff) | ((c + (offset & 0xff00)) & 0xff00));
+        for (int k = 0; k < KERNEL_LANES; k++) texel[k] = texture[index[k]];
+        vu32 s = scale_bytes(load_u8_lanes(shade + i), (vu32){ 0 } + level);
+        store_u32(dst + i, 0xff000000 | scale_bytes(load_u32(texel), s));
+    }
+    for (; i < count; i++) {
+        Uint32 t = texture[texel_index_one(uv[i], offset)];
+        Uint32 s = shade[i] * level >> 8;
+        dst[i] = 0xff000000 | (((t & 0xff00ff) * s >> 8) & 0xff00ff) | (((t & 0x00ff00) * s >> 8) & 0x00ff00);
+    }
+}
+
+// Coordinates for a whole vector are stepped at once; the texel fetch is
+// a gather, done lane by lane
+static void KERNEL_FN(rotozoom_span)(Uint32* dst, Uint32 u, Uint32 v, Uint32 du, Uint32 dv,
+                                     Uint32 level, const Uint32* texture, int count) {
+    vu32 vu, vv;
+    for (int k = 0; k < KERNEL_LANES; k++) {
+        vu[k] = u + du * k;
+        vv[k] = v + dv * k;
+    }
+    int i = 0;
+    for (; i + KERNEL_LANES <= count; i += KERNEL_LANES) {
+        vu32 index = (vv >> 8 & 0xff00) | (vu >> 16 & 0xff);
+        vu32 t;
+        for (int k = 0; k < KERNEL_LANES; k++) t[k] = texture[index[k]];
+        store_u32(dst + i, 0xff000000 | (((t & 0xff00ff) * level >> 8) & 0xff00ff) | (((t & 0x00ff00) * level >> 8) & 0x00ff00));
+        vu += du * KERNEL_LANES;
+        vv += dv * KERNEL_LANES;
+    }
+    u += du * i;
+    v += dv * i;
+    for (; i < count; i++) {
+        Uint32 t = texture[(v >> 8 & 0xff00) | (u >> 16 & 0xff)];
+        dst[i] = 0xff000000 | (((t & 0xff00ff) * level >> 8) & 0xff00ff) | (((t & 0x00ff00) * level >> 8) & 0x00ff00);
+        u += du;
+        v += dv;
+    }
+}
+
+// Sums are widened to 16 bits, so a vector holds half as many cells
+static void KERNEL_FN(fire_row)(Uint8* dst, const Uint8* below, const Uint8* below2, int count, Uint32 cool) {
+    const int lanes = KERNEL_VEC16_BYTES / 2;
+    int i = 0;
+    for (; i + lanes <= count; i += lanes) {
+        vu16 sum = load_u8_wide(below + i - 1) + load_u8_wide(below + i) + load_u8_wide(below + i + 1) +
+                   load_u8_wide(below2 + i);
+        vu16 hot = (vu16)(sum > (Uint16)cool);
+        store_u8_narrow(dst + i, ((sum - (Uint16)cool) & hot) >> 2);
+    }
+    for (; i < count; i++) {
+        Uint32 sum = below[i - 1] + below[i] + below[i + 1] + below2[i];
+        dst[i] = (Uint8)(sum > cool ? (sum - cool) >> 2 : 0);
+    }
+}
+
+// Palette lookups are gathers, lane by lane; the saturating add is vector-wide
+static void KERNEL_FN(heat_span)(Uint32* dst, const Uint8* heat, Uint32 u, Uint32 du, const Uint32* palette, int count) {
+    int i = 0;
+    for (; i + KERNEL_LANES <= count; i += KERNEL_LANES) {
+        vu32 c;
+        for (int k = 0; k < KERNEL_LANES; k++, u += du) c[k] = palette[heat[u >> 16]];
+        vu32 d = load_u32(dst + i);
+        vu32 rb = (d & 0xff00ff) + (c & 0xff00ff);
+        vu32 g = (d & 0x00ff00) + (c & 0x00ff00);
+        rb |= (rb & 0x01000100) - ((rb & 0x01000100) >> 8);
+        g |= (g & 0x00010000) - ((g & 0x00010000) >> 8);
+        store_u32(dst + i, 0xff000000 | (rb & 0xff00ff) | (g & 0x00ff00));
+    }
+    for (; i < count; i++, u += du) dst[i] = add_one(dst[i], palette[heat[u >> 16]]);
+}
+
+// A vector of pixels at a time, each blob's contribution accumulated in
+// registers; only the palette lookup goes lane by lane
+static void KERNEL_FN(metaball_span)(Uint32* dst, float x, float y, const float* bx, const float* by,
+                                     const float* inv_r2, int blobs, const Uint32* palette, int count) {
+    vf32 lane;
+    for (int k = 0; k < KERNEL_LANES; k++) lane[k] = (float)k;
+    int i = 0;
+    for (; i + KERNEL_LANES <= count; i += KERNEL_LANES) {
+        vf32 px = (x + (float)i) + lane;
+        vf32 field = (vf32){ 0 };
+        for (int b = 0; b < blobs; b++) {
+            vf32 dx = px - bx[b];
+            float dy = y - by[b];
+            vf32 t = 1.0f - (dx * dx + dy * dy) * inv_r2[b];
+            t = (vf32)((vu32)t & (vu32)(t > 0.0f));
+            field += t * t;
+        }
+        vf32 index = field * 128.0f;
+        vu32 below = (vu32)(index < 255.0f);
+        vu32 clamped = ((vu32)index & below) | ((vu32)((vf32){ 0 } + 255.0f) & ~below);
+        vu32 n = (vu32)__builtin_convertvector((vf32)clamped, vs32);
+        vu32 c;
+        for (int k = 0; k < KERNEL_LANES; k++) c[k] = palette[n[k]];
+        vu32 d = load_u32(dst + i);
+        vu32 rb = (d & 0xff00ff) + (c & 0xff00ff);
+        vu32 g = (d & 0x00ff00) + (c & 0x00ff00);
+        rb |= (rb & 0x01000100) - ((rb & 0x01000100) >> 8);
+        g |= (g & 0x00010000) - ((g & 0x00010000) >> 8);
+        store_u32(dst + i, 0xff000000 | (rb & 0xff00ff) | (g & 0x00ff00));
+    }
+    for (; i < count; i++) {
+        float px = x + (float)i, field = 0.0f;
+        for (int b = 0; b < blobs; b++) {
+            float dx = px - bx[b], dy = y - by[b];
+            float t = 1.0f - (dx * dx + dy * dy) * inv_r2[b];
+            t = t > 0.0f ? t : 0.0f;
+            field += t * t;
+        }
+        float index = field * 128.0f;
+        dst[i] = add_one(dst[i], palette[index < 255.0f ? (int)index : 255]);
+    }
+}
+
+static void KERNEL_FN(advance_stars)(float* z, const float* speed, int count, float step) {
+    int i = 0;
+    for (; i + KERNEL_LANES <= count; i += KERNEL_LANES) {
+        store_f32(z + i, load_f32(z + i) - load_f32(speed + i) * step);
+    }
+    for (; i < count; i++) z[i] -= speed[i] * step;
+}
+
+static void KERNEL_FN(project_stars)(const float* x, const float* y, const float* z, int count,
+                                     float cx, float cy, float spread, float* px, float* py, float* size) {
+    int i = 0;
+    for (; i + KERNEL_LANES <= count; i += KERNEL_LANES) {
+        vf32 vz = load_f32(z + i);
+        vf32 k = 128.0f / vz;
+        store_f32(px + i, load_f32(x + i) * k + cx);
+        store_f32(py + i, load_f32(y + i) * k + cy);
+        store_f32(size + i, (1.0f - vz / spread) * 3.0f);
+    }
+    for (; i < count; i++) {
+        float k = 128.0f / z[i];
+        px[i] = x[i] * k + cx;
+        py[i] = y[i] * k + cy;
+        size[i] = (1.0f - z[i] / spread) * 3.0f;
+    }
+}
+
+static void KERNEL_FN(advance_particles)(float* x, float* y, float* vx, float* vy, float* life, int count,
+                                         float dt, float gravity, float drag) {
+    float fall = gravity * dt;
+    int i = 0;
+    for (; i + KERNEL_LANES <= count; i += KERNEL_LANES) {
+        vf32 px = load_f32(x + i), py = load_f32(y + i);
+        vf32 pvx = load_f32(vx + i), pvy = load_f32(vy + i);
+        store_f32(x + i, px + pvx * dt);
+        store_f32(y + i, py + pvy * dt);
+        store_f32(vx + i, pvx * drag);
+        store_f32(vy + i, pvy * drag + fall);
+        store_f32(life + i, load_f32(life + i) - dt);
+    }
+    for (; i < count; i++) {
+        x[i] += vx[i] * dt;
+        y[i] += vy[i] * dt;
+        vx[i] = vx[i] * drag;
+        vy[i] = vy[i] * drag + fall;
+        life[i] -= dt;
+    }
+}
+
+static void KERNEL_FN(transform_points)(const float* x, const float* y, const float* z, int count, const float* m,
+                                        float* out_x, float* out_y, float* out_z) {
+    int i = 0;
+    for (; i + KERNEL_LANES <= count; i += KERNEL_LANES) {
+        vf32 vx = load_f32(x + i), vy = load_f32(y + i), vz = load_f32(z + i);
+        store_f32(out_x + i, m[0] * vx + m[1] * vy + m[2] * vz + m[3]);
+        store_f32(out_y + i, m[4] * vx + m[5] * vy + m[6] * vz + m[7]);
+        store_f32(out_z + i, m[8] * vx + m[9] * vy + m[10] * vz + m[11]);
+    }
+    for (; i < count; i++) {
+        out_x[i] = m[0] * x[i] + m[1] * y[i] + m[2] * z[i] + m[3];
+        out_y[i] = m[4] * x[i] + m[5] * y[i] + m[6] * z[i] + m[7];
+        out_z[i] = m[8] * x[i] + m[9] * y[i] + m[10] * z[i] + m[11];
+    }
+}
+
+const Kernels KERNEL_CAT(kernels, KERNEL_SET) = {
+    KERNEL_NAME,
+    KERNEL_FN(fill_span),
+    KERNEL_FN(blend_span),
+    KERNEL_FN(blend_row),
+    KERNEL_FN(plasma_span),
+    KERNEL_FN(tunnel_span),
+    KERNEL_FN(rotozoom_span),
+    KERNEL_FN(fire_row),
+    KERNEL_FN(heat_span),
+    KERNEL_FN(metaball_span),
+    KERNEL_FN(advance_stars),
+    KERNEL_FN(project_stars),
+    KERNEL_FN(advance_particles),
+    KERNEL_FN(transform_points),
+};
@@ -0,0 +1,25 @@
+/*
+ * kernels_sse2.c - 16-byte vector kernels built for SSE2.
+ */
+
+#include <SDL.h>
+#include "kernels.h"
+
+#if defined(__x86_64__) || defined(__i386__)
+
+#if defined(__clang__)
+#pragma clang attribute push (__attribute__((target("sse2"))), apply_to = function)
+#else
+#pragma GCC target("sse2")
+#endif
+
+#define KERNEL_VEC_BYTES 16
+#define KERNEL_SET sse2
+#define KERNEL_NAME "sse2"
+#include "kernels_impl.h"
+
+#if defined(__clang__)
+#pragma clang attribute pop
+#endif
+
+#endif
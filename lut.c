@@ -0,0 +1,16 @@
+/*
+ * lut.c - Shared lookup tables.
+ */
+
+#include <SDL.h>
+#include <math.h>
+#include "lut.h"
+
+Sint16 sine_lut[SINE_STEPS];
+
+
+void init_luts() {
+    for (int i = 0; i < SINE_STEPS; i++) {
+        sine_lut[i] = (Sint16)floor(sin(2.0 * M_PI * i / SINE_STEPS) * SINE_ONE + 0.5);
+    }
+}
@@ -0,0 +1,30 @@
+/*
+ * lut.h - Lookup tables shared by the per-pixel effects.
+ *
+ * Angles are table steps: SINE_STEPS make a full turn, and any integer
+ * wraps, so phases can be kept in plain (fixed-point) integers. Values are
+ * Q14 fixed point, SINE_ONE being 1.0. init_luts() must run before the
+ * effects are initialized.
+ */
+
+#ifndef LUT_H
+#define LUT_H
+
+#include <SDL.h>
+
+#define SINE_STEPS 1024 // One full turn, a power of two
+#define SINE_ONE 16384  // 1.0 in Q14
+
+extern Sint16 sine_lut[SINE_STEPS];
+
+void init_luts();
+
+static inline int lut_sin(Uint32 angle) {
+    return sine_lut[angle & (SINE_STEPS - 1)];
+}
+
+static inline int lut_cos(Uint32 angle) {
+    return sine_lut[(angle + SINE_STEPS / 4) & (SINE_STEPS - 1)];
+}
+
+#endif
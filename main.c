@@ -3,7 +3,8 @@
  *
  * Cross-compiles on Linux for Windows.
  * Creates a 3D starfield, a color-cycling sine-wave text scroller,
- * a raster bar, and plays background music.
+ * a raster bar, and plays background music. The effects themselves live
+ * in fx_*.c and are sequenced by the timeline in show.c.
  */
 
 #define SDL_MAIN_HANDLED
@@ -14,61 +15,110 @@
 #include <stdlib.h>
 #include <string.h>
 #include <time.h>
-#include <math.h>
-
-// --- Constants ---
-#define SCREEN_WIDTH 800
-#define SCREEN_HEIGHT 600
-#define NUM_STARS 500
-#define STAR_SPREAD 512
-
-// --- Structs ---
-typedef struct {
-    float x, y, z;
-    float speed;
-} Star;
+#include "demo.h"
+#include "audio.h"
+#include "effect.h"
+#include "cmdbuf.h"
+#include "sim.h"
+#include "governor.h"
+#include "stats.h"
+#include "backend.h"
+#include "jobs.h"
+#include "tiles.h"
+#include "kernels.h"
+#include "lut.h"
+#include "capture.h"
+#include "export.h"
 
 // --- Globals ---
 SDL_Window* window = NULL;
 SDL_Renderer* renderer = NULL;
 TTF_Font* font = NULL;
-Mix_Music* music = NULL;
-
-SDL_Color textColor = { 0, 255, 0, 255 }; // Initial color, will be modulated
-Star stars[NUM_STARS];
-const char* scrollText = "GREETINGS FROM A C AND SDL2 DEMO... NOW WITH MUSIC, RASTER BARS AND COLOR CYCLING TEXT... ENJOY THE SHOW...";
-float scrollX;
-float time_counter = 0;
-
+SDL_atomic_t output_w;
+SDL_atomic_t output_h;
+
+// Command line settings
+int audio_rate = AUDIO_DEFAULT_RATE;
+int audio_chunk = AUDIO_DEFAULT_CHUNK;
+int use_synth = 0;        // Built-in tracker synth instead of music.ogg
+int threaded_sim = 1;     // Run the simulation on its own thread
+int use_governor = 1;     // Adapt quality to hold the frame budget
+int start_quality = QUALITY_LEVELS - 1;
+float target_fps = 60.0f;
+float max_render_scale = 1.0f; // Upper bound on the internal resolution
+int linear_filter = 1;         // Filter used to upscale a reduced-resolution scene
+int window_w = DEFAULT_WIDTH;
+int window_h = DEFAULT_HEIGHT;
+int fullscreen = 0;
+int benchmark_frames = 0; // Print a timing report after this many frames
+int frame_limit = 0;      // 0 = run until the window is closed
+const char* renderer_name = NULL; // NULL = SDL default order
+int auto_renderer = 0;            // Probe the drivers and use the fastest
+int reprobe_renderer = 0;         // Probe even if a winner is cached
+int cpu_render = -1;              // CPU framebuffer: 1 on, 0 off, -1 with the software renderer
+int job_threads = 0;              // 0 = one per CPU
+const char* simd_set = NULL;      // NULL = widest the CPU supports
+int deterministic = 0;            // Fixed seed, one fixed step per frame, no governor
+const char* golden_path = NULL;   // Golden hash file to check against or record
+int record_golden = 0;
+const char* export_path = NULL;   // Render offline to this video file, "-" for stdout
+const char* export_wav = NULL;
+int export_rgb = 0;               // Raw RGB24 instead of Y4M
+int export_frames = 0;            // 0 = one loop of the show
 
 // --- Function Prototypes ---
+int parse_args(int argc, char* argv[]);
 int init_sdl();
 int init_font();
-int init_audio();
-void init_stars();
+int renderer_is_software();
+void update_screen_size();
+void toggle_fullscreen();
 void cleanup();
-void update_stars();
-void render_stars();
-void render_raster_bar();
-void render_scroller(SDL_Texture* textTexture, int textWidth, int textHeight);
-SDL_Texture* create_text_texture(const char* text, int* w, int* h);
 
 // --- Main Function ---
 int main(int argc, char* argv[]) {
     // --- Initialization ---
+    if (parse_args(argc, argv) != 0) return 1;
+    srand(deterministic ? DEMO_SEED : (unsigned)time(NULL));
+    if (init_cmdbuf() != 0) return 1; // Before SDL, the renderer probe records through it
     if (init_sdl() != 0) return 1;
     if (init_font() != 0) return 1;
-    if (init_audio() != 0) return 1;
+    if (init_audio(audio_rate, audio_chunk, use_synth) != 0) return 1;
+    if (init_stats(renderer) != 0) return 1;
+    if (init_governor(use_governor, start_quality, target_fps) != 0) return 1;
+    if (init_kernels(simd_set) != 0) return 1;
+    printf("Kernels: %s\n", kernels->name);
+    init_luts();
+    if (init_jobs(job_threads) != 0) return 1;
+    if (cpu_render < 0) cpu_render = renderer_is_software();
+    set_tiles_enabled(cpu_render);
+    if (cpu_render) {
+        printf("CPU framebuffer: %dx%d tiles on %d threads\n", TILE_SIZE, TILE_SIZE, job_thread_count());
+    }
 
-    Mix_PlayMusic(music, -1); // Play music, loop forever
+    set_scale_filter(linear_filter);
+    if (init_show(renderer) != 0 || init_sim(threaded_sim) != 0) {
+        cleanup();
+        return 1;
+    }
 
-    init_stars();
-    scrollX = SCREEN_WIDTH;
+    // Exports pull the music themselves, in step with the frames
+    if (export_path) {
+        if (export_frames == 0) export_frames = (int)(timeline_length() / FRAME_DT + 0.5f);
+        frame_limit = export_frames;
+        if (init_export(renderer, export_path, export_rgb, export_wav) != 0) {
+            finish_export();
+            cleanup();
+            return 1;
+        }
+    } else {
+        play_audio(); // Play music, loop forever
+    }
 
-    // Create texture from the scroll text
-    int textW, textH;
-    SDL_Texture* textTexture = create_text_texture(scrollText, &textW, &textH);
-    if (!textTexture) {
+    // Golden runs cover one loop of the show unless --benchmark says otherwise
+    if (golden_path && frame_limit == 0) frame_limit = (int)(timeline_length() / FRAME_DT + 0.5f);
+    if (init_capture(golden_path, record_golden, frame_limit) != 0) {
+        if (export_path) finish_export();
         cleanup();
         return 1;
     }
@@ -77,221 +127,349 @@ int main(int argc, char* argv[]) {
     int is_running = 1;
     SDL_Event e;
     Uint32 last_tick = SDL_GetTicks();
+    int frame = 0;
 
     while (is_running) {
+        stats_begin_frame();
+
         // Event handling
         while (SDL_PollEvent(&e) != 0) {
             if (e.type == SDL_QUIT) {
                 is_running = 0;
+            } else if (e.type == SDL_KEYDOWN && e.key.keysym.sym == SDLK_F1) {
+                toggle_stats_overlay();
+            } else if (e.type == SDL_KEYDOWN && e.key.keysym.sym == SDLK_F11) {
+                toggle_fullscreen();
+            } else if (e.type == SDL_WINDOWEVENT && e.window.event == SDL_WINDOWEVENT_SIZE_CHANGED) {
+                // Only the size-dependent caches are rebuilt
+                update_screen_size();
+                if (resize_timeline(renderer) != 0) is_running = 0;
             }
         }
 
-        // --- Update Game Logic ---
-        update_stars();
-        scrollX -= 1.5f;
-        if (scrollX < -textW) {
-            scrollX = SCREEN_WIDTH;
+        // --- Drawing ---
+        // The simulation thread keeps stepping the effects meanwhile
+        const TimelineSnapshot* snap = sim_acquire();
+
+        // The governor may lower the resolution further, never raise it above --scale
+        float scale = current_quality()->render_scale;
+        if (scale > max_render_scale) scale = max_render_scale;
+        if (set_render_scale(renderer, scale) != 0) {
+            is_running = 0;
         }
-        time_counter += 0.05f;
 
-        // --- Drawing ---
         SDL_SetRenderDrawColor(renderer, 0, 0, 0, 255); // Black
         SDL_RenderClear(renderer);
 
-        // Draw game objects
-        render_stars();
-        render_raster_bar();
-        render_scroller(textTexture, textW, textH);
+        render_timeline(renderer, snap);
+        capture_frame(renderer, frame);
+        if (export_path && export_frame(renderer) != 0) is_running = 0;
+        render_stats_overlay(renderer);
+
+        stats_mark_present();
+        cmd_present(renderer);
+        stats_end_frame();
+        update_governor(last_frame_ms(), last_busy_ms());
 
-        SDL_RenderPresent(renderer);
+        frame++;
+        if (frame_limit > 0 && frame >= frame_limit) {
+            is_running = 0;
+        }
 
-        // Frame rate limiting
+        // Frame rate limiting; deterministic runs only care about the frame count
         Uint32 current_tick = SDL_GetTicks();
-        if (current_tick - last_tick < 16) {
+        if (!deterministic && current_tick - last_tick < 16) {
              SDL_Delay(16 - (current_tick - last_tick));
         }
         last_tick = current_tick;
     }
 
     // --- Cleanup ---
-    SDL_DestroyTexture(textTexture);
+    if (benchmark_frames > 0) {
+        print_benchmark_report();
+    }
+    int status = finish_capture(renderer);
+    if (export_path && finish_export() != 0) status = 1;
     cleanup();
-    return 0;
+    return status;
 }
 
 // --- Function Implementations ---
 
-// Initialize SDL and create a window/renderer
-int init_sdl() {
-    // We now initialize AUDIO as well as VIDEO
-    if (SDL_Init(SDL_INIT_VIDEO | SDL_INIT_AUDIO) < 0) {
-        printf("SDL could not initialize! SDL_Error: %s\n", SDL_GetError());
-        return 1;
+// Parse command line options
+int parse_args(int argc, char* argv[]) {
+    for (int i = 1; i < argc; i++) {
+        if (strcmp(argv[i], "--rate") == 0 && i + 1 < argc) {
+            audio_rate = atoi(argv[++i]);
+        } else if (strcmp(argv[i], "--chunk") == 0 && i + 1 < argc) {
+            audio_chunk = atoi(argv[++i]);
+        } else if (strcmp(argv[i], "--synth") == 0) {
+            use_synth = 1;
+        } else if (strcmp(argv[i], "--single-thread") == 0) {
+            threaded_sim = 0;
+        } else if (strcmp(argv[i], "--quality") == 0 && i + 1 < argc) {
+            start_quality = atoi(argv[++i]);
+        } else if (strcmp(argv[i], "--fixed-quality") == 0) {
+            use_governor = 0;
+        } else if (strcmp(argv[i], "--target-fps") == 0 && i + 1 < argc) {
+            target_fps = (float)atof(argv[++i]);
+        } else if (strcmp(argv[i], "--scale") == 0 && i + 1 < argc) {
+            max_render_scale = (float)atof(argv[++i]);
+            if (max_render_scale > 1.0f) max_render_scale /= 100.0f; // Accept percentages too
+        } else if (strcmp(argv[i], "--filter") == 0 && i + 1 < argc) {
+            i++;
+            if (strcmp(argv[i], "nearest") == 0) {
+                linear_filter = 0;
+            } else if (strcmp(argv[i], "linear") == 0) {
+                linear_filter = 1;
+            } else {
+                printf("Unknown filter '%s', expected 'nearest' or 'linear'.\n", argv[i]);
+                return 1;
+            }
+        } else if (strcmp(argv[i], "--width") == 0 && i + 1 < argc) {
+            window_w = atoi(argv[++i]);
+        } else if (strcmp(argv[i], "--height") == 0 && i + 1 < argc) {
+            window_h = atoi(argv[++i]);
+        } else if (strcmp(argv[i], "--fullscreen") == 0) {
+            fullscreen = 1;
+        } else if (strcmp(argv[i], "--benchmark") == 0 && i + 1 < argc) {
+            benchmark_frames = atoi(argv[++i]);
+        } else if (strcmp(argv[i], "--renderer") == 0 && i + 1 < argc) {
+            renderer_name = argv[++i];
+        } else if (strcmp(argv[i], "--auto-renderer") == 0) {
+            auto_renderer = 1;
+        } else if (strcmp(argv[i], "--reprobe") == 0) {
+            auto_renderer = 1;
+            reprobe_renderer = 1;
+        } else if (strcmp(argv[i], "--cpu-render") == 0) {
+            cpu_render = 1;
+        } else if (strcmp(argv[i], "--no-cpu-render") == 0) {
+            cpu_render = 0;
+        } else if (strcmp(argv[i], "--threads") == 0 && i + 1 < argc) {
+            job_threads = atoi(argv[++i]);
+        } else if (strcmp(argv[i], "--simd") == 0 && i + 1 < argc) {
+            simd_set = argv[++i];
+        } else if (strcmp(argv[i], "--list-simd") == 0) {
+            list_kernels();
+            return 1;
+        } else if (strcmp(argv[i], "--deterministic") == 0) {
+            deterministic = 1;
+        } else if (strcmp(argv[i], "--golden") == 0 && i + 1 < argc) {
+            golden_path = argv[++i];
+            record_golden = 0;
+        } else if (strcmp(argv[i], "--record-golden") == 0 && i + 1 < argc) {
+            golden_path = argv[++i];
+            record_golden = 1;
+        } else if (strcmp(argv[i], "--export") == 0 && i + 1 < argc) {
+            export_path = argv[++i];
+        } else if (strcmp(argv[i], "--export-wav") == 0 && i + 1 < argc) {
+            export_wav = argv[++i];
+        } else if (strcmp(argv[i], "--export-rgb") == 0) {
+            export_rgb = 1;
+        } else if (strcmp(argv[i], "--export-frames") == 0 && i + 1 < argc) {
+            export_frames = atoi(argv[++i]);
+        } else if (strcmp(argv[i], "--list-renderers") == 0) {
+            list_render_drivers();
+            return 1;
+        } else {
+            printf("Usage: %s [--rate HZ] [--chunk FRAMES] [--synth] [--single-thread]\n"
+                   "       [--quality LEVEL] [--fixed-quality] [--target-fps FPS]\n"
+                   "       [--scale FACTOR] [--filter nearest|linear]\n"
+                   "       [--width W] [--height H] [--fullscreen] [--benchmark FRAMES]\n"
+                   "       [--renderer NAME | --auto-renderer [--reprobe]] [--list-renderers]\n"
+                   "       [--cpu-render | --no-cpu-render] [--threads N]\n"
+                   "       [--simd SET] [--list-simd]\n"
+                   "       [--deterministic] [--golden FILE | --record-golden FILE]\n"
+                   "       [--export FILE|- [--export-rgb] [--export-wav FILE] [--export-frames N]]\n", argv[0]);
+            printf("  --rate HZ           Audio sample rate (default %d)\n", AUDIO_DEFAULT_RATE);
+            printf("  --chunk FRAMES      Audio buffer size in sample frames (default %d)\n", AUDIO_DEFAULT_CHUNK);
+            printf("  --synth             Play the built-in tracker song instead of music.ogg\n");
+            printf("  --single-thread     Step the simulation on the main thread, once per frame\n");
+            printf("  --quality LEVEL     Starting quality, 0 (lowest) to %d (default)\n", QUALITY_LEVELS - 1);
+            printf("  --fixed-quality     Keep the starting quality instead of adapting it\n");
+            printf("  --target-fps FPS    Frame rate the quality governor aims for (default 60)\n");
+            printf("  --scale FACTOR      Internal resolution, e.g. 0.5 or 75 (percent); default 1\n");
+            printf("  --filter MODE       Upscaling filter for reduced resolution: nearest or linear\n");
+            printf("  --width W           Window width in pixels (default %d)\n", DEFAULT_WIDTH);
+            printf("  --height H          Window height in pixels (default %d)\n", DEFAULT_HEIGHT);
+            printf("  --fullscreen        Start in desktop fullscreen\n");
+            printf("  --benchmark FRAMES  Run for FRAMES frames, then print timing stats\n");
+            printf("  --renderer NAME     Use this SDL render driver, e.g. opengl or software\n");
+            printf("  --auto-renderer     Use the fastest driver, probed once and cached\n");
+            printf("  --reprobe           Probe the drivers again even if a winner is cached\n");
+            printf("  --list-renderers    List the render drivers in this build and exit\n");
+            printf("  --cpu-render        Draw on the CPU in parallel tiles (default with the software renderer)\n");
+            printf("  --no-cpu-render     Always draw through the SDL renderer\n");
+            printf("  --threads N         Threads for CPU drawing (default: one per CPU)\n");
+            printf("  --simd SET          Kernel set: scalar, sse2, avx2 or avx512 (default: best)\n");
+            printf("  --list-simd         List the kernel sets and whether this CPU runs them\n");
+            printf("  --deterministic     Fixed seed and one fixed step per frame, no quality changes\n");
+            printf("  --golden FILE       Deterministic run; check frame hashes against FILE\n");
+            printf("  --record-golden FILE  Deterministic run; write frame hashes to FILE\n");
+            printf("  --export FILE       Render offline as fast as possible to a Y4M video (- = stdout)\n");
+            printf("  --export-rgb        Write raw RGB24 frames instead of Y4M\n");
+            printf("  --export-wav FILE   Also write the soundtrack, in sync, to a WAV file\n");
+            printf("  --export-frames N   Frames to export (default: one loop of the show)\n");
+            printf("Press F1 while running to toggle the stats overlay, F11 for fullscreen.\n");
+            return 1;
+        }
     }
-    window = SDL_CreateWindow("C Scroller Demo", SDL_WINDOWPOS_CENTERED, SDL_WINDOWPOS_CENTERED, SCREEN_WIDTH, SCREEN_HEIGHT, SDL_WINDOW_SHOWN);
-    if (!window) {
-        printf("Window could not be created! SDL_Error: %s\n", SDL_GetError());
+    // Golden runs are deterministic; their default length needs the show
+    frame_limit = benchmark_frames;
+    if ((export_wav || export_rgb || export_frames) && !export_path) {
+        printf("The export options need --export FILE.\n");
         return 1;
     }
-    renderer = SDL_CreateRenderer(window, -1, SDL_RENDERER_ACCELERATED | SDL_RENDERER_PRESENTVSYNC);
-    if (!renderer) {
-        printf("Renderer could not be created! SDL_Error: %s\n", SDL_GetError());
+    if (export_frames < 0) {
+        printf("Export frame count must not be negative.\n");
         return 1;
     }
-    return 0;
-}
-
-// Initialize SDL_ttf and load a font
-int init_font() {
-    if (TTF_Init() == -1) {
-        printf("SDL_ttf could not initialize! TTF_Error: %s\n", TTF_GetError());
+    if (export_path) deterministic = 1;
+    if (golden_path) deterministic = 1;
+    if (deterministic) {
+        threaded_sim = 0;
+        use_governor = 0;
+    }
+    if (window_w <= 0 || window_h <= 0) {
+        printf("Window size must be positive.\n");
         return 1;
     }
-    font = TTF_OpenFont("font.ttf", 24);
-    if (!font) {
-        printf("Failed to load font! TTF_Error: %s\n", TTF_GetError());
-        printf("Please ensure 'font.ttf' is in the same directory as the executable.\n");
-        SDL_Delay(5000); 
+    if (max_render_scale < 0.1f || max_render_scale > 1.0f) {
+        printf("Render scale must be between 0.1 and 1 (10%% to 100%%).\n");
         return 1;
     }
-    return 0;
-}
-
-// Initialize SDL_mixer and load music
-int init_audio() {
-    // Open audio with standard settings
-    if (Mix_OpenAudio(44100, MIX_DEFAULT_FORMAT, 2, 2048) < 0) {
-        printf("SDL_mixer could not initialize! Mix_Error: %s\n", Mix_GetError());
+    if (job_threads < 0) {
+        printf("Thread count must not be negative.\n");
         return 1;
     }
-    // IMPORTANT: You must provide a path to a music file.
-    // This example assumes a file named "music.ogg" is in the same directory.
-    music = Mix_LoadMUS("music.ogg");
-    if (!music) {
-        printf("Failed to load music! Mix_Error: %s\n", Mix_GetError());
-        printf("Please ensure 'music.ogg' is in the same directory as the executable.\n");
-        SDL_Delay(5000);
+    if (audio_rate <= 0 || audio_chunk <= 0) {
+        printf("Audio rate and chunk size must be positive.\n");
         return 1;
     }
     return 0;
 }
 
-
-// Create the text texture to be rendered
-SDL_Texture* create_text_texture(const char* text, int* w, int* h) {
-    SDL_Surface* textSurface = TTF_RenderText_Blended(font, text, textColor);
-    if (!textSurface) {
-        printf("Unable to render text surface! TTF_Error: %s\n", TTF_GetError());
-        return NULL;
-    }
-    
-    SDL_Texture* texture = SDL_CreateTextureFromSurface(renderer, textSurface);
-    if (!texture) {
-        printf("Unable to create texture from rendered text! SDL_Error: %s\n", SDL_GetError());
+// Initialize SDL and create a window/renderer
+int init_sdl() {
+    // We now initialize AUDIO as well as VIDEO
+    if (SDL_Init(SDL_INIT_VIDEO | SDL_INIT_AUDIO) < 0) {
+        printf("SDL could not initialize! SDL_Error: %s\n", SDL_GetError());
+        return 1;
     }
-    
-    *w = textSurface->w;
-    *h = textSurface->h;
-    
-    SDL_FreeSurface(textSurface);
-    return texture;
-}
-
-
-// Initialize star positions randomly
-void init_stars() {
-    srand(time(NULL));
-    for (int i = 0; i < NUM_STARS; i++) {
-        stars[i].x = (float)(rand() % STAR_SPREAD) - (STAR_SPREAD / 2);
-        stars[i].y = (float)(rand() % STAR_SPREAD) - (STAR_SPREAD / 2);
-        stars[i].z = (float)(rand() % STAR_SPREAD);
-        stars[i].speed = ((float)(rand() % 100) / 200.0f) + 0.2f;
+    // Exports draw into a hidden window of a fixed size
+    Uint32 flags = export_path ? SDL_WINDOW_HIDDEN : SDL_WINDOW_SHOWN | SDL_WINDOW_RESIZABLE;
+    flags |= SDL_WINDOW_ALLOW_HIGHDPI;
+    if (fullscreen) flags |= SDL_WINDOW_FULLSCREEN_DESKTOP;
+    window = SDL_CreateWindow("C Scroller Demo", SDL_WINDOWPOS_CENTERED, SDL_WINDOWPOS_CENTERED, window_w, window_h, flags);
+    if (!window) {
+        printf("Window could not be created! SDL_Error: %s\n", SDL_GetError());
+        return 1;
     }
-}
 
-// Update star positions to move them towards the camera
-void update_stars() {
-    for (int i = 0; i < NUM_STARS; i++) {
-        stars[i].z -= stars[i].speed;
-        if (stars[i].z <= 0) {
-            stars[i].x = (float)(rand() % STAR_SPREAD) - (STAR_SPREAD / 2);
-            stars[i].y = (float)(rand() % STAR_SPREAD) - (STAR_SPREAD / 2);
-            stars[i].z = STAR_SPREAD;
+    int driver = -1;
+    if (renderer_name) {
+        driver = find_render_driver(renderer_name);
+        if (driver < 0) {
+            printf("Unknown renderer '%s'.\n", renderer_name);
+            list_render_drivers();
+            return 1;
         }
+    } else if (auto_renderer) {
+        driver = probe_render_drivers(window, reprobe_renderer);
     }
-}
-
-// Render the stars using 2D projection
-void render_stars() {
-    SDL_SetRenderDrawColor(renderer, 255, 255, 255, 255); // White
-    for (int i = 0; i < NUM_STARS; i++) {
-        if (stars[i].z > 0) {
-            float k = 128.0f / stars[i].z;
-            int px = (int)(stars[i].x * k + SCREEN_WIDTH / 2);
-            int py = (int)(stars[i].y * k + SCREEN_HEIGHT / 2);
-
-            if (px >= 0 && px < SCREEN_WIDTH && py >= 0 && py < SCREEN_HEIGHT) {
-                float size = (1.0f - (stars[i].z / STAR_SPREAD)) * 3;
-                SDL_Rect r = { px, py, (int)size, (int)size };
-                SDL_RenderFillRect(renderer, &r);
-            }
+    // A named driver may be the software one, so don't insist on acceleration
+    Uint32 renderer_flags = export_path ? 0 : SDL_RENDERER_PRESENTVSYNC; // Exports run flat out
+    renderer = SDL_CreateRenderer(window, driver, renderer_flags | (driver < 0 ? SDL_RENDERER_ACCELERATED : 0));
+    if (!renderer && auto_renderer && driver >= 0) {
+        // The winner no longer starts (new drivers, different GPU): don't
+        // keep it, probe again and fall back to SDL's choice as a last resort
+        printf("Probed renderer failed to start (%s), probing again\n", SDL_GetError());
+        forget_render_driver();
+        driver = probe_render_drivers(window, 1);
+        if (driver >= 0) renderer = SDL_CreateRenderer(window, driver, renderer_flags);
+        if (!renderer) {
+            forget_render_driver();
+            renderer = SDL_CreateRenderer(window, -1, renderer_flags | SDL_RENDERER_ACCELERATED);
         }
     }
+    if (!renderer) {
+        printf("Renderer could not be created! SDL_Error: %s\n", SDL_GetError());
+        return 1;
+    }
+    SDL_RendererInfo info;
+    if (SDL_GetRendererInfo(renderer, &info) == 0) {
+        printf("Renderer: %s\n", info.name);
+    }
+    update_screen_size();
+    return 0;
 }
 
-// Render the moving, color-cycling raster bar
-void render_raster_bar() {
-    // Enable blending for transparency
-    SDL_SetRenderDrawBlendMode(renderer, SDL_BLENDMODE_BLEND);
-
-    // Calculate color based on time
-    Uint8 r = (Uint8)((sin(time_counter * 0.8f) + 1.0f) / 2.0f * 255);
-    Uint8 g = (Uint8)((sin(time_counter * 0.8f + 2.0f) + 1.0f) / 2.0f * 255);
-    Uint8 b = (Uint8)((sin(time_counter * 0.8f + 4.0f) + 1.0f) / 2.0f * 255);
-    
-    SDL_SetRenderDrawColor(renderer, r, g, b, 100); // 100 for alpha
+// SDL's software renderer draws on one thread; the CPU tiles beat it
+int renderer_is_software() {
+    SDL_RendererInfo info;
+    return SDL_GetRendererInfo(renderer, &info) == 0 && (info.flags & SDL_RENDERER_SOFTWARE);
+}
 
-    // Calculate position based on time
-    SDL_Rect bar;
-    bar.x = 0;
-    bar.w = SCREEN_WIDTH;
-    bar.h = SCREEN_HEIGHT / 8;
-    bar.y = (int)((sin(time_counter) + 1.0f) / 2.0f * (SCREEN_HEIGHT - bar.h));
+// Track the drawable size, which differs from the window size on HiDPI displays
+void update_screen_size() {
+    int w, h;
+    if (SDL_GetRendererOutputSize(renderer, &w, &h) != 0 || w <= 0 || h <= 0) return;
+    SDL_AtomicSet(&output_w, w);
+    SDL_AtomicSet(&output_h, h);
+}
 
-    SDL_RenderFillRect(renderer, &bar);
-    
-    // Disable blending
-    SDL_SetRenderDrawBlendMode(renderer, SDL_BLENDMODE_NONE);
+int screen_width() {
+    return SDL_AtomicGet(&output_w);
 }
 
+int screen_height() {
+    return SDL_AtomicGet(&output_h);
+}
 
-// Render the scrolling text with a sine wave and color cycling
-void render_scroller(SDL_Texture* textTexture, int textWidth, int textHeight) {
-    // Calculate color modulation based on time
-    Uint8 r = (Uint8)((sin(time_counter) + 1.0f) / 2.0f * 255);
-    Uint8 g = (Uint8)((sin(time_counter + 2.0f) + 1.0f) / 2.0f * 255);
-    Uint8 b = (Uint8)((sin(time_counter + 4.0f) + 1.0f) / 2.0f * 255);
-    SDL_SetTextureColorMod(textTexture, r, g, b);
+int view_width() {
+    int h = screen_height();
+    return h > 0 ? screen_width() * VIEW_HEIGHT / h : DEFAULT_WIDTH;
+}
 
-    // Calculate position with sine wave
-    SDL_Rect destRect;
-    destRect.x = (int)scrollX;
-    destRect.y = (int)((SCREEN_HEIGHT / 2) - (textHeight / 2) + (sin(time_counter * 2.0f) * (SCREEN_HEIGHT / 20)));
-    destRect.w = textWidth;
-    destRect.h = textHeight;
+float view_to_pixels() {
+    int h = screen_height();
+    return h > 0 ? (float)h / VIEW_HEIGHT : 1.0f;
+}
 
-    SDL_RenderCopy(renderer, textTexture, NULL, &destRect);
+// Switch between a window and desktop fullscreen; the resize event follows
+void toggle_fullscreen() {
+    Uint32 flags = SDL_GetWindowFlags(window);
+    SDL_SetWindowFullscreen(window, (flags & SDL_WINDOW_FULLSCREEN) ? 0 : SDL_WINDOW_FULLSCREEN_DESKTOP);
 }
 
+// Initialize SDL_ttf and load a font
+int init_font() {
+    if (TTF_Init() == -1) {
+        printf("SDL_ttf could not initialize! TTF_Error: %s\n", TTF_GetError());
+        return 1;
+    }
+    font = TTF_OpenFont("font.ttf", 24);
+    if (!font) {
+        printf("Failed to load font! TTF_Error: %s\n", TTF_GetError());
+        printf("Please ensure 'font.ttf' is in the same directory as the executable.\n");
+        SDL_Delay(5000); 
+        return 1;
+    }
+    return 0;
+}
 
 // Clean up all initialized resources
 void cleanup() {
-    if (music) Mix_FreeMusic(music);
+    cleanup_sim();
+    cleanup_timeline();
+    cleanup_jobs();
+    cleanup_audio();
+    cleanup_stats();
+    cleanup_cmdbuf();
     if (font) TTF_CloseFont(font);
     if (renderer) SDL_DestroyRenderer(renderer);
     if (window) SDL_DestroyWindow(window);
     
-    music = NULL;
     font = NULL;
     renderer = NULL;
     window = NULL;
@@ -0,0 +1,219 @@
+/*
+ * particles.c - Particle pools, integration and binned splatting.
+ *
+ * Binning is a parallel counting sort: every chunk of particles counts its
+ * particles per cell, a prefix sum over (cell, chunk) gives every chunk
+ * its own output slots, and the chunks then scatter in parallel. The
+ * chunk count is fixed, so the sorted order, and with it the picture,
+ * does not depend on the number of threads.
+ */
+
+#include <SDL.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "particles.h"
+#include "jobs.h"
+#include "kernels.h"
+
+// --- Constants ---
+#define STEP_CHUNK 16384 // Particles per job when integrating
+#define BIN_CHUNKS 16
+#define ALIGN_PARTICLES 16 // Array lengths, so each array is a whole number of cache lines
+#define CACHE_LINE 64
+#define NO_PIXEL 0xffffffffu
+
+typedef struct {
+    ParticlePool* p;
+    float dt, gravity, drag;
+} StepJob;
+
+typedef struct {
+    ParticlePool* p;
+    int w, h;
+    float scale;
+    Uint32 level;
+    float fade_k; // 256 / fade time
+    int chunk_size;
+} BinJob;
+
+
+// All per-particle arrays share one allocation. SDL_malloc only promises
+// 16-byte alignment, so the block is over-allocated and its start rounded
+// up to a cache line; every array then starts on one
+int init_particle_pool(ParticlePool* p, int capacity) {
+    memset(p, 0, sizeof(*p));
+    size_t n = (size_t)(capacity + ALIGN_PARTICLES - 1) / ALIGN_PARTICLES * ALIGN_PARTICLES;
+    p->block = SDL_malloc(n * (5 * sizeof(float) + 2 * sizeof(Uint32) + sizeof(ParticleSplat)) + CACHE_LINE - 1);
+    if (!p->block) {
+        printf("Could not allocate a pool of %d particles\n", capacity);
+        return 1;
+    }
+    uintptr_t block = ((uintptr_t)p->block + CACHE_LINE - 1) & ~(uintptr_t)(CACHE_LINE - 1);
+    p->x = (float*)block;
+    p->y = p->x + n;
+    p->vx = p->y + n;
+    p->vy = p->vx + n;
+    p->life = p->vy + n;
+    p->color = (Uint32*)(p->life + n);
+    p->pixel_of = p->color + n;
+    p->splats = (ParticleSplat*)(p->pixel_of + n);
+    p->capacity = capacity;
+    return 0;
+}
+
+void free_particle_pool(ParticlePool* p) {
+    SDL_free(p->block);
+    SDL_free(p->cell_start);
+    SDL_free(p->chunk_start);
+    memset(p, 0, sizeof(*p));
+}
+
+int spawn_particles(ParticlePool* p, int n) {
+    int first = p->count;
+    p->count = SDL_min(p->capacity, p->count + SDL_max(n, 0));
+    return first;
+}
+
+size_t particle_pool_bytes(const ParticlePool* p) {
+    size_t n = (size_t)(p->capacity + ALIGN_PARTICLES - 1) / ALIGN_PARTICLES * ALIGN_PARTICLES;
+    return n * (5 * sizeof(float) + 2 * sizeof(Uint32) + sizeof(ParticleSplat)) + CACHE_LINE - 1 +
+           sizeof(int) * (p->cells + 1) * (size_t)(BIN_CHUNKS + 1);
+}
+
+static void step_chunk(void* ctx, int index) {
+    const StepJob* job = ctx;
+    ParticlePool* p = job->p;
+    int first = index * STEP_CHUNK;
+    int n = SDL_min(STEP_CHUNK, p->count - first);
+    kernels->advance_particles(p->x + first, p->y + first, p->vx + first, p->vy + first,
+                               p->life + first, n, job->dt, job->gravity, job->drag);
+}
+
+// Integrate on the job pool, then swap-remove the dead
+void step_particles(ParticlePool* p, float dt, float gravity, float drag) {
+    StepJob job = { p, dt, gravity, drag };
+    run_jobs(step_chunk, &job, (p->count + STEP_CHUNK - 1) / STEP_CHUNK);
+
+    int i = 0;
+    while (i < p->count) {
+        if (p->life[i] > 0.0f) {
+            i++;
+            continue;
+        }
+        int last = --p->count;
+        p->x[i] = p->x[last];
+        p->y[i] = p->y[last];
+        p->vx[i] = p->vx[last];
+        p->vy[i] = p->vy[last];
+        p->life[i] = p->life[last];
+        p->color[i] = p->color[last];
+    }
+}
+
+static inline Uint32 cell_of(const ParticlePool* p, Uint32 pixel) {
+    return ((pixel >> 16) >> p->shift_y) * p->cells_x + ((pixel & 0xffff) >> p->shift_x);
+}
+
+static void count_chunk(void* ctx, int chunk) {
+    const BinJob* job = ctx;
+    ParticlePool* p = job->p;
+    int* counts = p->chunk_start + (size_t)chunk * p->cells;
+    memset(counts, 0, sizeof(int) * p->cells);
+
+    int first = chunk * job->chunk_size, last = SDL_min(p->count, first + job->chunk_size);
+    for (int i = first; i < last; i++) {
+        float fx = p->x[i] * job->scale, fy = p->y[i] * job->scale;
+        if (!(fx >= 0.0f && fx < job->w && fy >= 0.0f && fy < job->h)) {
+            p->pixel_of[i] = NO_PIXEL;
+            continue;
+        }
+        Uint32 pixel = (Uint32)fy << 16 | (Uint32)fx;
+        p->pixel_of[i] = pixel;
+        counts[cell_of(p, pixel)]++;
+    }
+}
+
+static void scatter_chunk(void* ctx, int chunk) {
+    const BinJob* job = ctx;
+    ParticlePool* p = job->p;
+    int* next = p->chunk_start + (size_t)chunk * p->cells;
+
+    int first = chunk * job->chunk_size, last = SDL_min(p->count, first + job->chunk_size);
+    for (int i = first; i < last; i++) {
+        Uint32 pixel = p->pixel_of[i];
+        if (pixel == NO_PIXEL) continue;
+        ParticleSplat* out = &p->splats[next[cell_of(p, pixel)]++];
+        out->pos = pixel;
+
+        float fade = p->life[i] * job->fade_k;
+        Uint32 a = (fade < 256.0f ? (Uint32)fade : 256) * job->level >> 8;
+        Uint32 c = p->color[i];
+        out->color = (((c & 0xff00ff) * a >> 8) & 0xff00ff) | (((c & 0x00ff00) * a >> 8) & 0x00ff00);
+    }
+}
+
+int bin_particles(ParticlePool* p, int w, int h, float scale, int cell_w, int cell_h,
+                  Uint32 level, float fade) {
+    p->shift_x = p->shift_y = 0;
+    while ((1 << p->shift_x) < cell_w) p->shift_x++;
+    while ((1 << p->shift_y) < cell_h) p->shift_y++;
+    int cells_x = ((w - 1) >> p->shift_x) + 1;
+    int cells = cells_x * (((h - 1) >> p->shift_y) + 1);
+    if (cells != p->cells || !p->cell_start) {
+        SDL_free(p->cell_start);
+        SDL_free(p->chunk_start);
+        p->cell_start = SDL_malloc(sizeof(int) * (cells + 1));
+        p->chunk_start = SDL_malloc(sizeof(int) * cells * BIN_CHUNKS);
+        if (!p->cell_start || !p->chunk_start) {
+            printf("Could not allocate %d particle bins\n", cells);
+            SDL_free(p->cell_start);
+            SDL_free(p->chunk_start);
+            p->cell_start = NULL;
+            p->chunk_start = NULL;
+            p->cells = 0;
+            return 1;
+        }
+        p->cells = cells;
+    }
+    p->cells_x = cells_x;
+
+    BinJob job = { p, w, h, scale, level, 256.0f / fade, (p->count + BIN_CHUNKS - 1) / BIN_CHUNKS };
+    run_jobs(count_chunk, &job, BIN_CHUNKS);
+
+    // Chunk by chunk within each cell, so the order matches a serial sort
+    int total = 0;
+    for (int cell = 0; cell < cells; cell++) {
+        p->cell_start[cell] = total;
+        for (int chunk = 0; chunk < BIN_CHUNKS; chunk++) {
+            int* slot = &p->chunk_start[(size_t)chunk * cells + cell];
+            int n = *slot;
+            *slot = total;
+            total += n;
+        }
+    }
+    p->cell_start[cells] = total;
+
+    run_jobs(scatter_chunk, &job, BIN_CHUNKS);
+    return 0;
+}
+
+// Saturating add of every particle binned into the tile's cell
+void splat_particles(const ParticlePool* p, const Tile* t) {
+    if (!p->cell_start) return;
+    Uint32 cell = cell_of(p, (Uint32)t->y << 16 | (Uint32)t->x);
+    if (cell >= (Uint32)p->cells) return;
+
+    for (int k = p->cell_start[cell]; k < p->cell_start[cell + 1]; k++) {
+        Uint32 pos = p->splats[k].pos;
+        Uint32* d = t->fb + (size_t)(pos >> 16) * t->pitch + (pos & 0xffff);
+        Uint32 c = p->splats[k].color;
+        // Carries out of a channel become an all-ones mask for that channel
+        Uint32 rb = (*d & 0xff00ff) + (c & 0xff00ff);
+        Uint32 g = (*d & 0x00ff00) + (c & 0x00ff00);
+        rb |= (rb & 0x01000100) - ((rb & 0x01000100) >> 8);
+        g |= (g & 0x00010000) - ((g & 0x00010000) >> 8);
+        *d = 0xff000000 | (rb & 0xff00ff) | (g & 0x00ff00);
+    }
+}
@@ -0,0 +1,62 @@
+/*
+ * particles.h - Particle engine: pooled structure-of-arrays storage,
+ * vectorized integration and tile-binned software splatting.
+ *
+ * A pool allocates all of its arrays once, up front. Spawning only bumps
+ * the live count, and a dead particle is removed by moving the last live
+ * one into its slot, so live particles always stay packed at the front
+ * where the kernels (kernels.h) can stream through them.
+ *
+ * Particles are drawn as single additive pixels. bin_particles() sorts
+ * them by the cell of the pixel grid they land in, on the job pool, so
+ * each tile or band (tiles.h) only visits its own particles and tiles can
+ * be splatted in parallel without locks. A pool belongs to one thread;
+ * only splat_particles() may run on several threads at once.
+ */
+
+#ifndef PARTICLES_H
+#define PARTICLES_H
+
+#include <SDL.h>
+#include "tiles.h"
+
+typedef struct {
+    Uint32 pos; // y << 16 | x, pixels
+    Uint32 color;
+} ParticleSplat;
+
+typedef struct {
+    // Live particles, indices [0, count)
+    float* x;
+    float* y;      // Position, view units
+    float* vx;
+    float* vy;     // Velocity, view units per second
+    float* life;   // Seconds left
+    Uint32* color; // ARGB at full life
+    int count, capacity;
+    void* block;   // Allocation behind all of the arrays above and below
+
+    // Sorted by cell in the last bin_particles() call
+    ParticleSplat* splats;
+    Uint32* pixel_of;    // Scratch: pixel per particle
+    int* cell_start;     // First splat of each cell, cells + 1 entries
+    int* chunk_start;    // Scratch: per chunk and cell
+    int cells, cells_x;
+    int shift_x, shift_y; // Cell size as powers of two
+} ParticlePool;
+
+int init_particle_pool(ParticlePool* p, int capacity);
+void free_particle_pool(ParticlePool* p);
+int spawn_particles(ParticlePool* p, int n); // Index of the first of up to n new particles
+void step_particles(ParticlePool* p, float dt, float gravity, float drag);
+size_t particle_pool_bytes(const ParticlePool* p);
+
+// Sort for a w x h pixel grid of cells of at least cell_w x cell_h (the
+// sizes are rounded up to powers of two, so TILE_SIZE tiles, or bands as
+// wide as the grid, map to exactly one cell). Colours are scaled by
+// level (0..256) and faded out over the last `fade` seconds.
+int bin_particles(ParticlePool* p, int w, int h, float scale, int cell_w, int cell_h,
+                  Uint32 level, float fade);
+void splat_particles(const ParticlePool* p, const Tile* t);
+
+#endif
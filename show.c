@@ -0,0 +1,54 @@
+/*
+ * show.c - The demo's running order.
+ *
+ * Effects are listed back to front. Each cue gives an effect's time span in
+ * seconds, its fade in/out times and its parameters at the start and end
+ * of the span. The show loops after SHOW_LENGTH seconds.
+ */
+
+#include <SDL.h>
+#include "effect.h"
+
+#define SHOW_LENGTH 114.0f
+
+static Effect* show_effects[] = {
+    &plasma_effect,
+    &tunnel_effect,
+    &rotozoom_effect,
+    &stars_effect,
+    &voxel_effect,
+    &metaballs_effect,
+    &particles_effect,
+    &raster_effect,
+    &fire_effect,
+    &vector_effect,
+    &logo_effect,
+    &scroller_effect,
+    &title_effect,
+};
+
+static const Cue show_cues[] = {
+    //  effect            start  end          in    out   params from                   params to
+    { &plasma_effect,     12.0f, 48.0f,       3.0f, 3.0f, { 1.0f, 1.0f },               { 1.5f, 0.7f } },
+    { &tunnel_effect,     48.0f, 60.0f,       2.0f, 3.0f, { 60.0f, 10.0f },             { 90.0f, -20.0f } },
+    { &rotozoom_effect,   60.0f, 74.0f,       2.0f, 2.0f, { 0.5f, 1.0f },               { 1.2f, 0.8f } },
+    { &stars_effect,      0.0f,  84.0f,       0.0f, 0.0f, { 1.0f, 0.0f },               { 1.0f, 0.0f } },
+    { &stars_effect,      84.0f, 100.0f,      0.0f, 0.0f, { 1.0f, 0.0f },               { 4.0f, 0.9f } },
+    { &stars_effect,      100.0f, SHOW_LENGTH, 0.0f, 0.0f, { 4.0f, 0.9f },              { 1.0f, 0.0f } },
+    { &voxel_effect,      98.0f, SHOW_LENGTH, 3.0f, 2.0f, { 60.0f, 300.0f, 0.5f },      { 90.0f, 900.0f, 1.0f } },
+    { &metaballs_effect,  74.0f, 88.0f,       2.0f, 2.0f, { 0.3f, 60.0f },              { 0.8f, 40.0f } },
+    { &particles_effect,  18.0f, 46.0f,       2.0f, 2.0f, { 1.0f },                     { 1.0f } },
+    { &raster_effect,     0.0f,  SHOW_LENGTH, 0.0f, 0.0f, { 0.8f, 0.125f },             { 0.8f, 0.125f } },
+    { &fire_effect,       0.0f,  12.0f,       1.5f, 3.0f, { 0.5f, 0.2f },               { 0.5f, 0.2f } },
+    { &fire_effect,       64.0f, 74.0f,       4.0f, 2.0f, { 0.4f, 0.2f },               { 0.7f, 1.0f } },
+    { &vector_effect,     86.0f, 93.0f,       2.0f, 1.0f, { 1.0f, 0.0f, 0.0f },         { 1.5f, 0.0f, 1.0f } },
+    { &vector_effect,     93.0f, 100.0f,      1.0f, 2.0f, { 1.5f, 1.0f, 1.0f },         { 1.0f, 1.0f, 0.0f } },
+    { &logo_effect,       76.0f, 87.0f,       2.0f, 1.5f, { 20.0f, 0.5f },              { 60.0f, 1.0f } },
+    { &scroller_effect,   0.0f,  SHOW_LENGTH, 0.0f, 0.0f, { 90.0f, 0.05f },             { 90.0f, 0.05f } },
+    { &title_effect,      0.5f,  8.0f,        1.0f, 1.5f, { 0.25f },                    { 0.25f } },
+};
+
+int init_show(SDL_Renderer* renderer) {
+    return init_timeline(renderer, show_effects, SDL_arraysize(show_effects),
+                         show_cues, SDL_arraysize(show_cues), SHOW_LENGTH);
+}
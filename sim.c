@@ -0,0 +1,106 @@
+/*
+ * sim.c - Simulation thread feeding timeline snapshots to the renderer.
+ *
+ * The simulation steps the timeline at a fixed FRAME_DT on its own thread
+ * and publishes each result into a triple buffer: one snapshot being
+ * written, one ready, and one the main thread is drawing. Neither side
+ * ever waits for the other, so a slow step overlaps with the main thread
+ * blocking in SDL_RenderPresent, and the renderer always picks up the
+ * newest complete snapshot.
+ *
+ * With threading off (--single-thread) the main thread runs one step per
+ * frame itself, through the same buffers.
+ */
+
+#include <SDL.h>
+#include <stdio.h>
+#include "demo.h"
+#include "sim.h"
+
+// --- Constants ---
+#define SLOT_FRESH 4 // Set on `ready` when it holds a snapshot not yet taken
+
+// --- Globals ---
+static TimelineSnapshot* slots[3];
+static int back_slot = 0;     // Simulation thread only
+static int front_slot = 1;    // Main thread only
+static SDL_atomic_t ready;    // Slot index | SLOT_FRESH
+static SDL_atomic_t quit;
+static SDL_Thread* sim_thread = NULL;
+static int sim_threaded = 0;
+
+
+// Advance the show one step and hand the result over
+static void sim_step() {
+    update_timeline(FRAME_DT);
+    publish_timeline(slots[back_slot]);
+    back_slot = SDL_AtomicSet(&ready, back_slot | SLOT_FRESH) & 3;
+}
+
+// Step in real time; after a long stall, skip ahead rather than catch up
+static int sim_thread_main(void* data) {
+    Uint64 freq = SDL_GetPerformanceFrequency();
+    Uint64 step = (Uint64)(freq * FRAME_DT);
+    Uint64 next = SDL_GetPerformanceCounter();
+
+    while (!SDL_AtomicGet(&quit)) {
+        Uint64 now = SDL_GetPerformanceCounter();
+        if (now < next) {
+            Uint32 ms = (Uint32)((next - now) * 1000 / freq);
+            SDL_Delay(ms > 0 ? ms : 1);
+            continue;
+        }
+        sim_step();
+        next += step;
+        if (now > next + freq / 4) next = now;
+    }
+    return 0;
+}
+
+int init_sim(int threaded) {
+    for (int i = 0; i < 3; i++) {
+        slots[i] = create_timeline_snapshot();
+        if (!slots[i]) {
+            printf("Could not allocate timeline snapshots\n");
+            return 1;
+        }
+    }
+    back_slot = 0;
+    front_slot = 1;
+    SDL_AtomicSet(&ready, 2);
+    SDL_AtomicSet(&quit, 0);
+
+    // Publish a first snapshot so the renderer always has something to draw
+    sim_step();
+
+    sim_threaded = threaded;
+    if (threaded) {
+        sim_thread = SDL_CreateThread(sim_thread_main, "simulation", NULL);
+        if (!sim_thread) {
+            printf("Could not start simulation thread! SDL_Error: %s\n", SDL_GetError());
+            return 1;
+        }
+    }
+    return 0;
+}
+
+// Newest complete snapshot; stays valid until the next call
+const TimelineSnapshot* sim_acquire() {
+    if (!sim_threaded) sim_step();
+    if (SDL_AtomicGet(&ready) & SLOT_FRESH) {
+        front_slot = SDL_AtomicSet(&ready, front_slot) & 3;
+    }
+    return slots[front_slot];
+}
+
+void cleanup_sim() {
+    if (sim_thread) {
+        SDL_AtomicSet(&quit, 1);
+        SDL_WaitThread(sim_thread, NULL);
+        sim_thread = NULL;
+    }
+    for (int i = 0; i < 3; i++) {
+        destroy_timeline_snapshot(slots[i]);
+        slots[i] = NULL;
+    }
+}
@@ -0,0 +1,14 @@
+/*
+ * sim.h - Simulation thread feeding timeline snapshots to the renderer.
+ */
+
+#ifndef SIM_H
+#define SIM_H
+
+#include "effect.h"
+
+int init_sim(int threaded);
+const TimelineSnapshot* sim_acquire();
+void cleanup_sim();
+
+#endif
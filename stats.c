@@ -0,0 +1,272 @@
+/*
+ * stats.c - Frame timing, on-screen stats overlay and benchmark report.
+ *
+ * The overlay text is only re-rasterized a few times per second so that
+ * turning it on does not itself show up in the frame times it reports.
+ */
+
+#include <SDL.h>
+#include <SDL_ttf.h>
+#include <stdio.h>
+#include "stats.h"
+#include "audio.h"
+#include "effect.h"
+#include "cmdbuf.h"
+#include "governor.h"
+#include "tiles.h"
+#include "kernels.h"
+
+// --- Constants ---
+#define STATS_FONT_SIZE 14
+#define STATS_REFRESH_MS 500
+#define STATS_MAX_LINES 16
+#define STATS_LINE_LEN 128
+
+// --- Globals ---
+static TTF_Font* stats_font = NULL;
+static SDL_Texture* stats_texture = NULL;
+static int stats_tex_w = 0;
+static int stats_tex_h = 0;
+static int overlay_visible = 0;
+static Uint32 last_refresh = 0;
+
+static Uint64 frame_start = 0;
+static Uint64 present_start = 0;
+static double perf_to_ms = 0.0;
+static double frame_ms = 0.0;
+static double busy_ms = 0.0;
+
+// Rolling window, reset every refresh
+static int window_frames = 0;
+static double window_sum = 0.0;
+static double window_max = 0.0;
+
+// Whole-run totals for the benchmark report
+static unsigned long total_frames = 0;
+static double total_sum = 0.0;
+static double total_min = 1e9;
+static double total_max = 0.0;
+static Uint64 run_start = 0;
+static unsigned long total_layers_cached = 0;
+static unsigned long total_layers_redrawn = 0;
+static unsigned long total_commands = 0;
+static unsigned long total_batches = 0;
+static double total_raster_ms = 0.0;
+static double total_upload_ms = 0.0;
+
+
+// Load the overlay font and start the run clock
+int init_stats(SDL_Renderer* renderer) {
+    stats_font = TTF_OpenFont("font.ttf", STATS_FONT_SIZE);
+    if (!stats_font) {
+        printf("Failed to load stats font! TTF_Error: %s\n", TTF_GetError());
+        return 1;
+    }
+    perf_to_ms = 1000.0 / (double)SDL_GetPerformanceFrequency();
+    run_start = SDL_GetPerformanceCounter();
+    return 0;
+}
+
+void stats_begin_frame() {
+    frame_start = SDL_GetPerformanceCounter();
+    present_start = 0;
+}
+
+// Everything before this point is CPU work; after it, submission and vsync wait
+void stats_mark_present() {
+    present_start = SDL_GetPerformanceCounter();
+}
+
+// Frame time covers update, draw and present (including vsync wait)
+void stats_end_frame() {
+    Uint64 now = SDL_GetPerformanceCounter();
+    double ms = (double)(now - frame_start) * perf_to_ms;
+    frame_ms = ms;
+    busy_ms = present_start ? (double)(present_start - frame_start) * perf_to_ms : ms;
+
+    window_frames++;
+    window_sum += ms;
+    if (ms > window_max) window_max = ms;
+
+    total_frames++;
+    total_sum += ms;
+    if (ms < total_min) total_min = ms;
+    if (ms > total_max) total_max = ms;
+
+    LayerStats ls;
+    get_layer_stats(&ls);
+    total_layers_cached += ls.cached;
+    total_layers_redrawn += ls.redrawn;
+
+    CmdStats cs;
+    get_cmd_stats(&cs);
+    total_commands += cs.commands;
+    total_batches += cs.batches;
+
+    if (tiles_enabled()) {
+        TileStats ts;
+        get_tile_stats(&ts);
+        total_raster_ms += ts.raster_ms;
+        total_upload_ms += ts.upload_ms;
+    }
+}
+
+double last_frame_ms() {
+    return frame_ms;
+}
+
+double last_busy_ms() {
+    return busy_ms;
+}
+
+void toggle_stats_overlay() {
+    overlay_visible = !overlay_visible;
+    last_refresh = 0;
+}
+
+// Rebuild the overlay texture from the current figures
+static void refresh_overlay(SDL_Renderer* renderer) {
+    char lines[STATS_MAX_LINES][STATS_LINE_LEN];
+    int n = 0;
+
+    double avg = window_frames > 0 ? window_sum / window_frames : 0.0;
+    snprintf(lines[n++], STATS_LINE_LEN, "FPS %.1f  frame %.2f ms (max %.2f)",
+             avg > 0.0 ? 1000.0 / avg : 0.0, avg, window_max);
+
+    const Quality* q = current_quality();
+    snprintf(lines[n++], STATS_LINE_LEN, "Quality %d  stars %d%%  particles %d%%  scale %d%%  detail %d",
+             current_quality_level(), (int)(q->star_fraction * 100), (int)(q->particle_fraction * 100),
+             (int)(get_render_scale() * 100), q->detail);
+
+    snprintf(lines[n++], STATS_LINE_LEN, "Show %.1f s  effects %d/%d active  tables %.1f MB",
+             timeline_time(), timeline_active_count(), timeline_effect_count(),
+             timeline_table_bytes() / (1024.0 * 1024.0));
+
+    LayerStats ls;
+    get_layer_stats(&ls);
+    snprintf(lines[n++], STATS_LINE_LEN, "Layers %d cached  %d redrawn  %d direct",
+             ls.cached, ls.redrawn, ls.direct);
+
+    CmdStats cs;
+    get_cmd_stats(&cs);
+    snprintf(lines[n++], STATS_LINE_LEN, "Draw %d commands in %d batches  %d state changes",
+             cs.commands, cs.batches, cs.state_changes);
+
+    if (tiles_enabled()) {
+        TileStats ts;
+        get_tile_stats(&ts);
+        snprintf(lines[n++], STATS_LINE_LEN, "CPU %d tiles on %d threads (%s)  raster %.2f ms  upload %.2f ms",
+                 ts.tiles, ts.threads, kernels->name, ts.raster_ms, ts.upload_ms);
+    }
+
+    AudioStats a;
+    get_audio_stats(&a);
+    snprintf(lines[n++], STATS_LINE_LEN, "Audio %d Hz  chunk %d req / %d got (%.1f ms)",
+             a.rate, a.requested_chunk, a.buffer_frames, a.buffer_ms);
+    snprintf(lines[n++], STATS_LINE_LEN, "Audio latency est. ~%.1f ms  period %.2f ms  jitter %.2f ms (max %.2f)",
+             a.latency_estimate_ms, a.period_ms, a.jitter_ms, a.max_period_ms);
+
+    window_frames = 0;
+    window_sum = 0.0;
+    window_max = 0.0;
+
+    // Render each line and stack them onto one surface
+    SDL_Color white = { 255, 255, 255, 255 };
+    SDL_Surface* rendered[STATS_MAX_LINES];
+    int w = 0, h = 0;
+    for (int i = 0; i < n; i++) {
+        rendered[i] = TTF_RenderText_Blended(stats_font, lines[i], white);
+        if (rendered[i]) {
+            if (rendered[i]->w > w) w = rendered[i]->w;
+            h += rendered[i]->h;
+        }
+    }
+
+    if (stats_texture) SDL_DestroyTexture(stats_texture);
+    stats_texture = NULL;
+
+    SDL_Surface* sheet = w > 0 ? SDL_CreateRGBSurfaceWithFormat(0, w, h, 32, SDL_PIXELFORMAT_ARGB8888) : NULL;
+    int y = 0;
+    for (int i = 0; i < n; i++) {
+        if (!rendered[i]) continue;
+        if (sheet) {
+            SDL_Rect dst = { 0, y, rendered[i]->w, rendered[i]->h };
+            SDL_SetSurfaceBlendMode(rendered[i], SDL_BLENDMODE_NONE);
+            SDL_BlitSurface(rendered[i], NULL, sheet, &dst);
+            y += rendered[i]->h;
+        }
+        SDL_FreeSurface(rendered[i]);
+    }
+    if (sheet) {
+        stats_texture = SDL_CreateTextureFromSurface(renderer, sheet);
+        stats_tex_w = w;
+        stats_tex_h = h;
+        SDL_FreeSurface(sheet);
+    }
+}
+
+// Draw the overlay in the top-left corner over a translucent backdrop
+void render_stats_overlay(SDL_Renderer* renderer) {
+    if (!overlay_visible) return;
+
+    Uint32 now = SDL_GetTicks();
+    if (last_refresh == 0 || now - last_refresh >= STATS_REFRESH_MS) {
+        refresh_overlay(renderer);
+        last_refresh = now;
+    }
+    if (!stats_texture) return;
+
+    cmd_next_group();
+    SDL_Rect back = { 4, 4, stats_tex_w + 8, stats_tex_h + 8 };
+    SDL_Color shade = { 0, 0, 0, 160 };
+    cmd_fill_rect(&back, shade, SDL_BLENDMODE_BLEND);
+
+    cmd_next_group();
+    SDL_Rect dst = { 8, 8, stats_tex_w, stats_tex_h };
+    SDL_Color white = { 255, 255, 255, 255 };
+    cmd_copy(stats_texture, NULL, &dst, white, SDL_BLENDMODE_BLEND);
+}
+
+// Summary printed to stdout when running with --benchmark
+void print_benchmark_report() {
+    double elapsed = (double)(SDL_GetPerformanceCounter() - run_start) * perf_to_ms;
+    double avg = total_frames > 0 ? total_sum / total_frames : 0.0;
+
+    printf("--- Benchmark ---\n");
+    printf("frames:        %lu in %.1f ms\n", total_frames, elapsed);
+    printf("frame time:    avg %.3f ms  min %.3f ms  max %.3f ms\n",
+           avg, total_frames > 0 ? total_min : 0.0, total_max);
+    printf("fps:           %.1f\n", elapsed > 0.0 ? total_frames * 1000.0 / elapsed : 0.0);
+    printf("quality:       level %d at exit, render scale %d%% (%s)\n",
+           current_quality_level(), (int)(get_render_scale() * 100),
+           get_scale_filter() ? "linear" : "nearest");
+    if (total_frames > 0) {
+        printf("layers:        %.2f cached, %.2f redrawn per frame\n",
+               (double)total_layers_cached / total_frames, (double)total_layers_redrawn / total_frames);
+        printf("draw:          %.1f commands in %.1f batches per frame\n",
+               (double)total_commands / total_frames, (double)total_batches / total_frames);
+    }
+    printf("kernels:       %s\n", kernels->name);
+    if (tiles_enabled() && total_frames > 0) {
+        TileStats ts;
+        get_tile_stats(&ts);
+        printf("cpu tiles:     %d on %d threads, raster %.3f ms  upload %.3f ms per frame\n",
+               ts.tiles, ts.threads, total_raster_ms / total_frames, total_upload_ms / total_frames);
+    }
+
+    AudioStats a;
+    get_audio_stats(&a);
+    printf("audio rate:    %d Hz, %d channels\n", a.rate, a.channels);
+    printf("audio buffer:  %d frames requested, %d delivered (%.2f ms)\n",
+           a.requested_chunk, a.buffer_frames, a.buffer_ms);
+    printf("audio latency: ~%.2f ms (estimate: two buffers)\n", a.latency_estimate_ms);
+    printf("audio period:  avg %.3f ms  jitter %.3f ms  max %.3f ms over %lu callbacks\n",
+           a.period_ms, a.jitter_ms, a.max_period_ms, a.callbacks);
+}
+
+void cleanup_stats() {
+    if (stats_texture) SDL_DestroyTexture(stats_texture);
+    if (stats_font) TTF_CloseFont(stats_font);
+    stats_texture = NULL;
+    stats_font = NULL;
+}
@@ -0,0 +1,21 @@
+/*
+ * stats.h - Frame timing, on-screen stats overlay and benchmark report.
+ */
+
+#ifndef STATS_H
+#define STATS_H
+
+#include <SDL.h>
+
+int init_stats(SDL_Renderer* renderer);
+void stats_begin_frame();
+void stats_mark_present();
+void stats_end_frame();
+double last_frame_ms();
+double last_busy_ms();
+void toggle_stats_overlay();
+void render_stats_overlay(SDL_Renderer* renderer);
+void print_benchmark_report();
+void cleanup_stats();
+
+#endif
@@ -0,0 +1,320 @@
+/*
+ * synth.c - Built-in tracker-style music player.
+ *
+ * The song is a few hundred bytes of pattern data: each channel has an
+ * order list of 16-row patterns and a fixed instrument (the drum channel
+ * picks its instrument from the note value instead). Channels are rendered
+ * in short blocks into mono float buffers and panned into a planar stereo
+ * mix with 4-wide vector arithmetic before conversion to 16-bit output.
+ */
+
+#include <SDL.h>
+#include <stdio.h>
+#include <string.h>
+#include <math.h>
+#include "synth.h"
+
+// --- Constants ---
+#define SYNTH_BLOCK 64          // Frames rendered per inner block (multiple of 4)
+#define SYNTH_CHANNELS 4
+#define SYNTH_ROWS 16           // Rows per pattern
+#define SYNTH_BPM 120
+#define SYNTH_ROWS_PER_BEAT 4
+#define SYNTH_SINE_SIZE 1024
+#define SYNTH_MASTER 0.45f
+
+#define NOTE_NONE 0
+#define NOTE_OFF 255
+
+enum { WAVE_SINE, WAVE_SQUARE, WAVE_SAW, WAVE_TRIANGLE, WAVE_NOISE };
+enum { DRUM_KICK = 1, DRUM_SNARE, DRUM_HAT };
+
+typedef float v4f __attribute__((vector_size(16)));
+
+// --- Structs ---
+typedef struct {
+    int wave;
+    float attack, decay, sustain, release; // Times in seconds, sustain is a level
+    float volume;
+    float pan;        // -1 left .. 1 right
+    float pitch_drop; // Exponential pitch fall per second (kick drums)
+    float vibrato;    // Vibrato depth in semitones
+} Instrument;
+
+typedef struct {
+    const Instrument* inst;
+    float phase;
+    float freq;
+    float env;
+    int stage; // 0 idle, 1 attack, 2 decay, 3 sustain, 4 release
+    float time;
+    Uint32 noise;
+} Voice;
+
+typedef struct {
+    const Instrument* inst;  // NULL for the drum channel
+    const Uint8 (*patterns)[SYNTH_ROWS];
+    const signed char* order; // Pattern per bar, -1 = rest
+} Track;
+
+// --- Song Data ---
+static const Instrument inst_bass  = { WAVE_SAW,      0.002f, 0.18f, 0.45f, 0.05f, 0.55f, -0.1f, 0.0f, 0.0f };
+static const Instrument inst_arp   = { WAVE_SQUARE,   0.001f, 0.08f, 0.20f, 0.04f, 0.22f,  0.5f, 0.0f, 0.0f };
+static const Instrument inst_lead  = { WAVE_TRIANGLE, 0.010f, 0.30f, 0.70f, 0.20f, 0.60f, -0.3f, 0.0f, 0.25f };
+static const Instrument inst_kick  = { WAVE_SINE,     0.001f, 0.20f, 0.00f, 0.01f, 1.00f,  0.0f, 9.0f, 0.0f };
+static const Instrument inst_snare = { WAVE_NOISE,    0.001f, 0.12f, 0.00f, 0.01f, 0.45f,  0.1f, 0.0f, 0.0f };
+static const Instrument inst_hat   = { WAVE_NOISE,    0.001f, 0.03f, 0.00f, 0.01f, 0.18f,  0.3f, 0.0f, 0.0f };
+
+static const Uint8 bass_patterns[][SYNTH_ROWS] = {
+    { 45,0,57,0, 45,0,57,0, 45,0,57,0, 45,0,57,45 }, // Am
+    { 41,0,53,0, 41,0,53,0, 41,0,53,0, 41,0,53,41 }, // F
+    { 48,0,60,0, 48,0,60,0, 48,0,60,0, 48,0,60,48 }, // C
+    { 43,0,55,0, 43,0,55,0, 43,0,55,0, 43,0,55,47 }, // G
+};
+
+static const Uint8 arp_patterns[][SYNTH_ROWS] = {
+    { 69,72,76,81, 69,72,76,81, 69,72,76,81, 69,72,76,81 },
+    { 65,69,72,77, 65,69,72,77, 65,69,72,77, 65,69,72,77 },
+    { 72,76,79,84, 72,76,79,84, 72,76,79,84, 72,76,79,84 },
+    { 67,71,74,79, 67,71,74,79, 67,71,74,79, 67,71,74,79 },
+};
+
+static const Uint8 lead_patterns[][SYNTH_ROWS] = {
+    { 76,0,0,0, 0,0,74,0, 72,0,0,0, 71,0,72,0 },
+    { 69,0,0,0, 0,0,0,0, 0,0,72,0, 74,0,0,0 },
+    { 76,0,0,0, 79,0,0,0, 77,0,76,0, 74,0,72,0 },
+    { 74,0,0,0, 0,0,71,0, 67,0,0,0, NOTE_OFF,0,0,0 },
+};
+
+#define K DRUM_KICK
+#define S DRUM_SNARE
+#define H DRUM_HAT
+static const Uint8 drum_patterns[][SYNTH_ROWS] = {
+    { K,0,H,0, S,0,H,0, K,0,H,K, S,0,H,0 },
+    { K,0,H,0, S,0,H,0, K,0,K,0, S,S,S,S },
+};
+#undef K
+#undef S
+#undef H
+
+#define SONG_BARS 16
+#define SONG_LOOP_BAR 4
+static const signed char bass_order[SONG_BARS] = { 0,1,2,3, 0,1,2,3, 0,1,2,3, 0,1,2,3 };
+static const signed char arp_order[SONG_BARS]  = { -1,-1,-1,-1, 0,1,2,3, 0,1,2,3, 0,1,2,3 };
+static const signed char lead_order[SONG_BARS] = { -1,-1,-1,-1, -1,-1,-1,-1, 0,1,2,3, 0,1,2,3 };
+static const signed char drum_order[SONG_BARS] = { 0,0,0,1, 0,0,0,1, 0,0,0,1, 0,0,0,1 };
+
+static const Track tracks[SYNTH_CHANNELS] = {
+    { &inst_bass, bass_patterns, bass_order },
+    { &inst_arp,  arp_patterns,  arp_order },
+    { &inst_lead, lead_patterns, lead_order },
+    { NULL,       drum_patterns, drum_order },
+};
+
+// --- Globals ---
+static int synth_rate = 0;
+static int synth_channels = 0;
+static float sine_table[SYNTH_SINE_SIZE];
+static Voice voices[SYNTH_CHANNELS];
+static int song_bar = 0;
+static int song_row = 0;
+static int samples_per_row = 0;
+static int samples_left = 0; // Until the next row
+
+static float mono[SYNTH_BLOCK] __attribute__((aligned(16)));
+static float mix_l[SYNTH_BLOCK] __attribute__((aligned(16)));
+static float mix_r[SYNTH_BLOCK] __attribute__((aligned(16)));
+
+
+// Prepare tables and sequencer for the given output format
+int init_synth(int rate, int channels) {
+    if (rate <= 0 || channels <= 0) {
+        printf("Synth: invalid output format (%d Hz, %d channels)\n", rate, channels);
+        return 1;
+    }
+    synth_rate = rate;
+    synth_channels = channels;
+    for (int i = 0; i < SYNTH_SINE_SIZE; i++) {
+        sine_table[i] = (float)sin(2.0 * M_PI * i / SYNTH_SINE_SIZE);
+    }
+    memset(voices, 0, sizeof(voices));
+    for (int c = 0; c < SYNTH_CHANNELS; c++) {
+        voices[c].noise = 0x12345u + c * 7919u;
+    }
+    samples_per_row = rate * 60 / (SYNTH_BPM * SYNTH_ROWS_PER_BEAT);
+    song_bar = 0;
+    song_row = 0;
+    samples_left = 0;
+    return 0;
+}
+
+static float note_freq(int note) {
+    return 440.0f * powf(2.0f, (note - 69) / 12.0f);
+}
+
+// Start or release the voice for one channel from the current row
+static void trigger_row() {
+    for (int c = 0; c < SYNTH_CHANNELS; c++) {
+        const Track* t = &tracks[c];
+        int pat = t->order[song_bar];
+        if (pat < 0) continue;
+        Uint8 note = t->patterns[pat][song_row];
+        Voice* v = &voices[c];
+
+        if (note == NOTE_NONE) continue;
+        if (note == NOTE_OFF) {
+            if (v->stage != 0) v->stage = 4;
+            continue;
+        }
+
+        if (t->inst) {
+            v->inst = t->inst;
+            v->freq = note_freq(note);
+        } else {
+            v->inst = note == DRUM_KICK ? &inst_kick : note == DRUM_SNARE ? &inst_snare : &inst_hat;
+            v->freq = 150.0f;
+        }
+        v->phase = 0.0f;
+        v->env = 0.0f;
+        v->time = 0.0f;
+        v->stage = 1;
+    }
+}
+
+// Advance to the next row, looping the song after the last bar
+static void advance_row() {
+    if (++song_row >= SYNTH_ROWS) {
+        song_row = 0;
+        if (++song_bar >= SONG_BARS) song_bar = SONG_LOOP_BAR;
+    }
+}
+
+// Render one voice into the mono buffer; returns 0 if it is silent
+static int render_voice(Voice* v, int frames) {
+    const Instrument* in = v->inst;
+    if (!in || v->stage == 0) return 0;
+
+    float dt = 1.0f / synth_rate;
+    float attack_step = dt / (in->attack > 0.0f ? in->attack : dt);
+    float decay_step = (1.0f - in->sustain) * dt / in->decay;
+    float release_step = dt / in->release;
+
+    // Pitch is held for the block; drops and vibrato only need control rate
+    float freq = v->freq;
+    if (in->pitch_drop > 0.0f) freq *= expf(-in->pitch_drop * v->time);
+    if (in->vibrato > 0.0f) freq *= powf(2.0f, in->vibrato * sinf(v->time * 34.0f) / 12.0f);
+    float inc = freq / synth_rate;
+
+    for (int i = 0; i < frames; i++) {
+        switch (v->stage) {
+            case 1:
+                v->env += attack_step;
+                if (v->env >= 1.0f) { v->env = 1.0f; v->stage = 2; }
+                break;
+            case 2:
+                v->env -= decay_step;
+                if (v->env <= in->sustain) {
+                    v->env = in->sustain;
+                    v->stage = in->sustain > 0.0f ? 3 : 0;
+                }
+                break;
+            case 4:
+                v->env -= release_step;
+                if (v->env <= 0.0f) { v->env = 0.0f; v->stage = 0; }
+                break;
+        }
+
+        float s;
+        switch (in->wave) {
+            case WAVE_SINE:     s = sine_table[(int)(v->phase * SYNTH_SINE_SIZE) & (SYNTH_SINE_SIZE - 1)]; break;
+            case WAVE_SQUARE:   s = v->phase < 0.5f ? 1.0f : -1.0f; break;
+            case WAVE_SAW:      s = 2.0f * v->phase - 1.0f; break;
+            case WAVE_TRIANGLE: s = v->phase < 0.5f ? 4.0f * v->phase - 1.0f : 3.0f - 4.0f * v->phase; break;
+            default:
+                v->noise ^= v->noise << 13;
+                v->noise ^= v->noise >> 17;
+                v->noise ^= v->noise << 5;
+                s = (float)(Sint32)v->noise * (1.0f / 2147483648.0f);
+                break;
+        }
+        mono[i] = s * v->env;
+
+        v->phase += inc;
+        if (v->phase >= 1.0f) v->phase -= 1.0f;
+    }
+    v->time += frames * dt;
+    return 1;
+}
+
+// Pan the mono buffer into the stereo mix, four frames at a time
+static void accumulate(const Instrument* in, int frames) {
+    float gain = in->volume * SYNTH_MASTER;
+    float gl = gain * (1.0f - in->pan) * 0.5f;
+    float gr = gain * (1.0f + in->pan) * 0.5f;
+    v4f vgl = { gl, gl, gl, gl };
+    v4f vgr = { gr, gr, gr, gr };
+
+    for (int i = 0; i < frames; i += 4) {
+        v4f m = *(const v4f*)&mono[i];
+        *(v4f*)&mix_l[i] += m * vgl;
+        *(v4f*)&mix_r[i] += m * vgr;
+    }
+}
+
+static Sint16 clamp_sample(float s) {
+    if (s > 32767.0f) return 32767;
+    if (s < -32768.0f) return -32768;
+    return (Sint16)s;
+}
+
+// Convert the planar float mix to interleaved 16-bit output
+static void write_output(Sint16* out, int frames) {
+    v4f scale = { 32767.0f, 32767.0f, 32767.0f, 32767.0f };
+    for (int i = 0; i < frames; i += 4) {
+        *(v4f*)&mix_l[i] *= scale;
+        *(v4f*)&mix_r[i] *= scale;
+    }
+
+    for (int i = 0; i < frames; i++) {
+        Sint16* frame = out + i * synth_channels;
+        if (synth_channels == 1) {
+            frame[0] = clamp_sample((mix_l[i] + mix_r[i]) * 0.5f);
+            continue;
+        }
+        frame[0] = clamp_sample(mix_l[i]);
+        frame[1] = clamp_sample(mix_r[i]);
+        for (int c = 2; c < synth_channels; c++) frame[c] = 0;
+    }
+}
+
+// Mix_HookMusic callback: fill the stream with the next part of the song
+void synth_mix(void* udata, Uint8* stream, int len) {
+    Sint16* out = (Sint16*)stream;
+    int frames_left = len / (int)(sizeof(Sint16) * synth_channels);
+
+    while (frames_left > 0) {
+        if (samples_left == 0) {
+            trigger_row();
+            advance_row();
+            samples_left = samples_per_row;
+        }
+
+        // Blocks stay a multiple of 4 frames except at the very end of a row
+        int frames = frames_left < SYNTH_BLOCK ? frames_left : SYNTH_BLOCK;
+        if (frames > samples_left) frames = samples_left;
+
+        memset(mix_l, 0, sizeof(mix_l));
+        memset(mix_r, 0, sizeof(mix_r));
+        for (int c = 0; c < SYNTH_CHANNELS; c++) {
+            memset(mono, 0, sizeof(mono));
+            if (render_voice(&voices[c], frames)) {
+                accumulate(voices[c].inst, (frames + 3) & ~3);
+            }
+        }
+        write_output(out, frames);
+
+        out += frames * synth_channels;
+        frames_left -= frames;
+        samples_left -= frames;
+    }
+}
@@ -0,0 +1,16 @@
+/*
+ * synth.h - Built-in tracker-style music player.
+ *
+ * Plays a small pattern-based song through a handful of oscillator
+ * channels, replacing music.ogg when the demo is started with --synth.
+ */
+
+#ifndef SYNTH_H
+#define SYNTH_H
+
+#include <SDL.h>
+
+int init_synth(int rate, int channels);
+void synth_mix(void* udata, Uint8* stream, int len);
+
+#endif
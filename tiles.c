@@ -0,0 +1,314 @@
+/*
+ * tiles.c - CPU framebuffer, tile bookkeeping and tile drawing primitives.
+ *
+ * Pixels are opaque ARGB8888 (the frame is cleared to black first), so
+ * blending only has to compute source-over for the colour channels. Edges
+ * follow the pixel-centre rule, like SDL_RenderGeometry, so the CPU path
+ * covers the same pixels as the GPU one. The span loops themselves are
+ * the dispatched kernels in kernels.h.
+ */
+
+#include <SDL.h>
+#include <stdio.h>
+#include <string.h>
+#include <math.h>
+#include "tiles.h"
+#include "jobs.h"
+#include "kernels.h"
+
+// --- Globals ---
+static int enabled = 0;
+static Uint32* framebuffer = NULL;
+static int fb_w = 0, fb_h = 0;
+static float fb_scale = 1.0f;
+static int tiles_x = 0, tiles_y = 0;
+static SDL_Texture* fb_texture = NULL;
+static int fb_linear = -1;
+static Uint64 raster_start = 0;
+static TileStats tile_stats;
+
+
+void set_tiles_enabled(int on) {
+    enabled = on;
+}
+
+int tiles_enabled() {
+    return enabled;
+}
+
+// Size the framebuffer and texture for this frame, then hand out tiles
+int begin_tiles(SDL_Renderer* renderer, int w, int h, float scale, int linear) {
+    if (w < 1) w = 1;
+    if (h < 1) h = 1;
+    if (!framebuffer || w != fb_w || h != fb_h || linear != fb_linear) {
+        if (fb_texture) SDL_DestroyTexture(fb_texture);
+        SDL_free(framebuffer);
+        SDL_SetHint(SDL_HINT_RENDER_SCALE_QUALITY, linear ? "linear" : "nearest");
+        fb_texture = SDL_CreateTexture(renderer, SDL_PIXELFORMAT_ARGB8888, SDL_TEXTUREACCESS_STREAMING, w, h);
+        SDL_SetHint(SDL_HINT_RENDER_SCALE_QUALITY, "nearest");
+        framebuffer = SDL_malloc(sizeof(Uint32) * w * h);
+        if (!fb_texture || !framebuffer) {
+            printf("Could not create CPU framebuffer! SDL_Error: %s\n", SDL_GetError());
+            cleanup_tiles();
+            return 1;
+        }
+#if SDL_VERSION_ATLEAST(2, 0, 12)
+        SDL_SetTextureScaleMode(fb_texture, linear ? SDL_ScaleModeLinear : SDL_ScaleModeNearest);
+#endif
+        fb_w = w;
+        fb_h = h;
+        fb_linear = linear;
+        tiles_x = (w + TILE_SIZE - 1) / TILE_SIZE;
+        tiles_y = (h + TILE_SIZE - 1) / TILE_SIZE;
+    }
+    fb_scale = scale;
+    raster_start = SDL_GetPerformanceCounter();
+    return 0;
+}
+
+int tile_count() {
+    return tiles_x * tiles_y;
+}
+
+void get_tile(int index, Tile* out) {
+    int tx = index % tiles_x, ty = index / tiles_x;
+    out->fb = framebuffer;
+    out->pitch = fb_w;
+    out->x = tx * TILE_SIZE;
+    out->y = ty * TILE_SIZE;
+    out->w = SDL_min(TILE_SIZE, fb_w - out->x);
+    out->h = SDL_min(TILE_SIZE, fb_h - out->y);
+    out->scale = fb_scale;
+}
+
+// All tiles are done: upload the frame in one go
+SDL_Texture* end_tiles(SDL_Renderer* renderer) {
+    double perf_to_ms = 1000.0 / SDL_GetPerformanceFrequency();
+    Uint64 upload_start = SDL_GetPerformanceCounter();
+    SDL_UpdateTexture(fb_texture, NULL, framebuffer, fb_w * (int)sizeof(Uint32));
+
+    Uint64 now = SDL_GetPerformanceCounter();
+    tile_stats.tiles = tile_count();
+    tile_stats.threads = job_thread_count();
+    tile_stats.raster_ms = (upload_start - raster_start) * perf_to_ms;
+    tile_stats.upload_ms = (now - upload_start) * perf_to_ms;
+    return fb_texture;
+}
+
+void get_tile_stats(TileStats* out) {
+    *out = tile_stats;
+}
+
+void cleanup_tiles() {
+    if (fb_texture) SDL_DestroyTexture(fb_texture);
+    SDL_free(framebuffer);
+    fb_texture = NULL;
+    framebuffer = NULL;
+    fb_w = fb_h = 0;
+    fb_linear = -1;
+    tiles_x = tiles_y = 0;
+}
+
+// --- Layers ---
+
+typedef struct {
+    TileFunc fn;
+    void* ctx;
+    Tile band;
+} BandJob;
+
+static void draw_band(void* ctx, int index) {
+    const BandJob* job = ctx;
+    Tile band = job->band;
+    band.y = index * TILE_SIZE;
+    band.h = SDL_min(TILE_SIZE, job->band.h - band.y);
+    job->fn(job->ctx, &band);
+}
+
+int draw_tile_layer(SDL_Renderer* renderer, TileLayer* layer, int w, int h, float scale,
+                    TileFunc fn, void* ctx) {
+    if (w < 1) w = 1;
+    if (h < 1) h = 1;
+    if (!layer->texture || w != layer->w || h != layer->h) {
+        free_tile_layer(layer);
+        // Reduced-resolution layers are stretched, so always filter them
+        SDL_SetHint(SDL_HINT_RENDER_SCALE_QUALITY, "linear");
+        layer->texture = SDL_CreateTexture(renderer, SDL_PIXELFORMAT_ARGB8888, SDL_TEXTUREACCESS_STREAMING, w, h);
+        SDL_SetHint(SDL_HINT_RENDER_SCALE_QUALITY, "nearest");
+        if (!layer->texture) {
+            printf("Could not create CPU layer! SDL_Error: %s\n", SDL_GetError());
+            return 1;
+        }
+#if SDL_VERSION_ATLEAST(2, 0, 12)
+        SDL_SetTextureScaleMode(layer->texture, SDL_ScaleModeLinear);
+#endif
+        layer->w = w;
+        layer->h = h;
+    }
+
+    void* pixels;
+    int pitch;
+    if (SDL_LockTexture(layer->texture, NULL, &pixels, &pitch) != 0) return 1;
+    // The whole layer is one tile h rows tall; each job takes TILE_SIZE of them
+    BandJob job = { fn, ctx, { pixels, pitch / (int)sizeof(Uint32), 0, 0, w, h, scale } };
+    run_jobs(draw_band, &job, (h + TILE_SIZE - 1) / TILE_SIZE);
+    SDL_UnlockTexture(layer->texture);
+    return 0;
+}
+
+void free_tile_layer(TileLayer* layer) {
+    if (layer->texture) SDL_DestroyTexture(layer->texture);
+    layer->texture = NULL;
+    layer->w = layer->h = 0;
+}
+
+// --- Drawing ---
+
+// View units to the first pixel whose centre lies at or past v
+static int to_pixel(float v, float scale) {
+    return (int)floorf(v * scale + 0.5f);
+}
+
+// Clip a view-unit rectangle to the tile; returns 0 if nothing is left
+static int clip_to_tile(const Tile* t, const SDL_Rect* r, int* x0, int* y0, int* x1, int* y1) {
+    *x0 = SDL_max(to_pixel((float)r->x, t->scale), t->x);
+    *y0 = SDL_max(to_pixel((float)r->y, t->scale), t->y);
+    *x1 = SDL_min(to_pixel((float)(r->x + r->w), t->scale), t->x + t->w);
+    *y1 = SDL_min(to_pixel((float)(r->y + r->h), t->scale), t->y + t->h);
+    return *x0 < *x1 && *y0 < *y1;
+}
+
+void tile_clear(const Tile* t, Uint32 argb) {
+    for (int y = t->y; y < t->y + t->h; y++) {
+        kernels->fill_span(t->fb + (size_t)y * t->pitch + t->x, t->w, argb);
+    }
+}
+
+void tile_fill_rect(const Tile* t, const SDL_Rect* rect, SDL_Color color) {
+    int x0, y0, x1, y1;
+    if (color.a == 0 || !clip_to_tile(t, rect, &x0, &y0, &x1, &y1)) return;
+
+    Uint32 src = 0xff000000 | ((Uint32)color.r << 16) | ((Uint32)color.g << 8) | color.b;
+    Uint32 a = color.a + (color.a >> 7);
+    for (int y = y0; y < y1; y++) {
+        Uint32* row = t->fb + (size_t)y * t->pitch + x0;
+        if (a == 256) {
+            kernels->fill_span(row, x1 - x0, src);
+        } else {
+            kernels->blend_span(row, x1 - x0, src, a);
+        }
+    }
+}
+
+// Pixels whose centres lie inside the triangle. Every edge is evaluated
+// from its upper end and rows and spans are half-open, so triangles that
+// share an edge neither leave gaps nor blend twice along it
+void tile_fill_triangle(const Tile* t, const float* x, const float* y, SDL_Color color) {
+    if (color.a == 0) return;
+    float px[3], py[3];
+    for (int i = 0; i < 3; i++) {
+        px[i] = x[i] * t->scale;
+        py[i] = y[i] * t->scale;
+    }
+    float top = SDL_min(py[0], SDL_min(py[1], py[2]));
+    float bottom = SDL_max(py[0], SDL_max(py[1], py[2]));
+    if (top >= t->y + t->h || bottom <= t->y) return;
+    int y0 = (int)ceilf(SDL_max(top - 0.5f, (float)t->y));
+    int y1 = (int)ceilf(SDL_min(bottom - 0.5f, (float)(t->y + t->h)));
+
+    Uint32 src = 0xff000000 | ((Uint32)color.r << 16) | ((Uint32)color.g << 8) | color.b;
+    Uint32 a = color.a + (color.a >> 7);
+    for (int row = y0; row < y1; row++) {
+        float cy = row + 0.5f;
+        float left = 1e30f, right = -1e30f;
+        for (int e = 0; e < 3; e++) {
+            int i = e, j = e == 2 ? 0 : e + 1;
+            if (py[i] > py[j]) {
+                int k = i;
+                i = j;
+                j = k;
+            }
+            if (cy < py[i] || cy >= py[j]) continue;
+            float cx = px[i] + (cy - py[i]) * (px[j] - px[i]) / (py[j] - py[i]);
+            left = SDL_min(left, cx);
+            right = SDL_max(right, cx);
+        }
+        if (left >= right || left >= t->x + t->w || right <= t->x) continue;
+        int x0 = (int)ceilf(SDL_max(left - 0.5f, (float)t->x));
+        int x1 = (int)ceilf(SDL_min(right - 0.5f, (float)(t->x + t->w)));
+        if (x0 >= x1) continue;
+        Uint32* span = t->fb + (size_t)row * t->pitch + x0;
+        if (a == 256) {
+            kernels->fill_span(span, x1 - x0, src);
+        } else {
+            kernels->blend_span(span, x1 - x0, src, a);
+        }
+    }
+}
+
+// Scaled copy with nearest sampling, colour and alpha modulation.
+// Each row is sampled into a scratch span, then blended in one kernel call.
+void tile_blit(const Tile* t, const TileImage* img, const SDL_Rect* dst, SDL_Color mod) {
+    tile_blit_part(t, img, NULL, dst, mod);
+}
+
+void tile_blit_part(const Tile* t, const TileImage* img, const SDL_Rect* src, const SDL_Rect* dst, SDL_Color mod) {
+    int x0, y0, x1, y1;
+    SDL_Rect whole = { 0, 0, img->w, img->h };
+    if (!src) src = &whole;
+    if (!img->pixels || mod.a == 0 || dst->w <= 0 || dst->h <= 0 || src->w <= 0 || src->h <= 0) return;
+    if (!clip_to_tile(t, dst, &x0, &y0, &x1, &y1)) return;
+
+    // Source position per destination pixel, 16.16 fixed point from pixel centres
+    float px_x = dst->x * t->scale, px_y = dst->y * t->scale;
+    Sint64 step_x = (Sint64)(65536.0f * src->w / (dst->w * t->scale));
+    Sint64 step_y = (Sint64)(65536.0f * src->h / (dst->h * t->scale));
+    Sint64 start_u = (Sint64)((x0 + 0.5f - px_x) * step_x);
+    Sint64 v = (Sint64)((y0 + 0.5f - px_y) * step_y);
+    Uint32 mr = mod.r + (mod.r >> 7), mg = mod.g + (mod.g >> 7), mb = mod.b + (mod.b >> 7);
+    Uint32 ma = mod.a + (mod.a >> 7);
+
+    Uint32 samples[TILE_SIZE];
+    for (int y = y0; y < y1; y++, v += step_y) {
+        int sy = src->y + SDL_max(0, SDL_min((int)(v >> 16), src->h - 1));
+        const Uint32* src_row = img->pixels + (size_t)sy * img->w + src->x;
+        Sint64 u = start_u;
+        for (int x = x0; x < x1; x++, u += step_x) {
+            samples[x - x0] = src_row[SDL_max(0, SDL_min((int)(u >> 16), src->w - 1))];
+        }
+        kernels->blend_row(t->fb + (size_t)y * t->pitch + x0, samples, x1 - x0, mr, mg, mb, ma);
+    }
+}
+
+// Keep a CPU copy of a surface in the framebuffer's pixel format
+int tile_image_from_surface(TileImage* img, SDL_Surface* surface) {
+    SDL_Surface* argb = SDL_ConvertSurfaceFormat(surface, SDL_PIXELFORMAT_ARGB8888, 0);
+    if (!argb) {
+        printf("Could not convert surface for the CPU renderer! SDL_Error: %s\n", SDL_GetError());
+        return 1;
+    }
+    Uint32* pixels = SDL_malloc(sizeof(Uint32) * argb->w * argb->h);
+    if (!pixels) {
+        SDL_FreeSurface(argb);
+        return 1;
+    }
+    SDL_LockSurface(argb);
+    for (int y = 0; y < argb->h; y++) {
+        memcpy(pixels + (size_t)y * argb->w, (Uint8*)argb->pixels + (size_t)y * argb->pitch,
+               sizeof(Uint32) * argb->w);
+    }
+    SDL_UnlockSurface(argb);
+
+    free_tile_image(img);
+    img->pixels = pixels;
+    img->w = argb->w;
+    img->h = argb->h;
+    SDL_FreeSurface(argb);
+    return 0;
+}
+
+void free_tile_image(TileImage* img) {
+    SDL_free(img->pixels);
+    img->pixels = NULL;
+    img->w = img->h = 0;
+}
@@ -0,0 +1,80 @@
+/*
+ * tiles.h - Tile-parallel CPU framebuffer.
+ *
+ * An alternative to SDL's single-threaded software renderer: the frame is
+ * drawn into a plain ARGB8888 buffer split into tiles, the tiles are
+ * rendered in parallel on the job pool (jobs.h), and the finished buffer
+ * is uploaded to one streaming texture per frame.
+ *
+ * Effects take part through their render_tile() hook (effect.h), which
+ * must draw only inside the tile it is given. It runs on several threads
+ * at once, so it may only read the snapshot and effect state that is
+ * fixed while the frame is drawn. Coordinates passed to the tile_*
+ * drawing functions are view units, like the command buffer's.
+ *
+ * Per-pixel effects use the same tiles on the GPU path: draw_tile_layer()
+ * fills a streaming texture of their own in full-width bands of TILE_SIZE
+ * rows on the job pool, so one function serves both paths.
+ */
+
+#ifndef TILES_H
+#define TILES_H
+
+#include <SDL.h>
+
+#define TILE_SIZE 64
+
+typedef struct {
+    Uint32* fb;     // Framebuffer base, ARGB8888
+    int pitch;      // Framebuffer row length in pixels
+    int x, y, w, h; // Tile area in framebuffer pixels
+    float scale;    // Framebuffer pixels per view unit
+} Tile;
+
+// CPU copy of a texture for tile_blit()
+typedef struct {
+    Uint32* pixels; // ARGB8888, w * h
+    int w, h;
+} TileImage;
+
+// Streaming texture filled on the CPU, see draw_tile_layer()
+typedef struct {
+    SDL_Texture* texture;
+    int w, h;
+} TileLayer;
+
+typedef void (*TileFunc)(void* ctx, const Tile* tile);
+
+typedef struct {
+    int tiles;
+    int threads;
+    double raster_ms; // Drawing all tiles, last frame
+    double upload_ms; // Texture upload, last frame
+} TileStats;
+
+void set_tiles_enabled(int enabled);
+int tiles_enabled();
+int begin_tiles(SDL_Renderer* renderer, int w, int h, float scale, int linear);
+int tile_count();
+void get_tile(int index, Tile* out);
+SDL_Texture* end_tiles(SDL_Renderer* renderer);
+void get_tile_stats(TileStats* out);
+void cleanup_tiles();
+
+// (Re)size the layer to w x h pixels, then fill it by calling fn on every band
+int draw_tile_layer(SDL_Renderer* renderer, TileLayer* layer, int w, int h, float scale,
+                    TileFunc fn, void* ctx);
+void free_tile_layer(TileLayer* layer);
+
+// Drawing, clipped to the tile; colours use straight alpha
+void tile_clear(const Tile* t, Uint32 argb);
+void tile_fill_rect(const Tile* t, const SDL_Rect* rect, SDL_Color color);
+// Corners x[0..2], y[0..2] in view units
+void tile_fill_triangle(const Tile* t, const float* x, const float* y, SDL_Color color);
+void tile_blit(const Tile* t, const TileImage* img, const SDL_Rect* dst, SDL_Color mod);
+// Part of the image, in image pixels; NULL copies all of it like tile_blit()
+void tile_blit_part(const Tile* t, const TileImage* img, const SDL_Rect* src, const SDL_Rect* dst, SDL_Color mod);
+int tile_image_from_surface(TileImage* img, SDL_Surface* surface);
+void free_tile_image(TileImage* img);
+
+#endif